@@ -0,0 +1,191 @@
+#include "vkei/descriptor_allocator.hpp"
+#include "vkei/descriptor_layout_builder.hpp"
+
+#include <VkBootstrap.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vulkan/vulkan_core.h>
+
+namespace
+{
+    using mdsm::vkei::DescriptorAllocator;
+    using mdsm::vkei::DescriptorLayoutBuilder;
+
+    constexpr std::size_t frame_count {16};
+    constexpr std::size_t sets_per_frame {100'000};
+
+    constexpr std::uint32_t initial_sets {1000};
+
+    // Pools only grow from initial_sets, so no frame ever needs more than this many
+    constexpr std::size_t max_pools {(sets_per_frame + initial_sets - 1) / initial_sets};
+
+    void require(const bool condition, const std::string_view message)
+    {
+        if(!condition)
+        {
+            throw std::runtime_error{std::string{message}};
+        }
+    }
+
+    // Allocates sets_per_frame sets every frame, clearing the pools in between like a frame's
+    // allocator does, and checks that the pools of the first frame are all later frames use
+    void run(const VkDevice device)
+    {
+        DescriptorLayoutBuilder layout_builder;
+
+        layout_builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        layout_builder.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+        const VkDescriptorSetLayout layout {
+            layout_builder.build(device, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+        };
+
+        // One descriptor of each type per set, pools run out of sets and descriptors together
+        std::array<DescriptorAllocator::PoolSizeRatio, 2> ratios {
+            DescriptorAllocator::PoolSizeRatio{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+            DescriptorAllocator::PoolSizeRatio{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}
+        };
+
+        DescriptorAllocator allocator;
+
+        allocator.initialize(device, initial_sets, ratios);
+
+        std::size_t warm_pools {};
+
+        for(std::size_t frame {}; frame < frame_count; ++frame)
+        {
+            allocator.clearPools(device);
+
+            const auto frame_start {std::chrono::steady_clock::now()};
+
+            for(std::size_t set {}; set < sets_per_frame; ++set)
+            {
+                allocator.allocate(device, layout);
+            }
+
+            const double milliseconds {
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count()
+            };
+
+            const DescriptorAllocator::AllocatorStatistics statistics {allocator.getStatistics()};
+
+            std::println(
+                "frame {:2}: {:.2f} ms, {} live pools, {} created, {} sets per pool, {} retries, clear {:.3f} ms",
+                frame,
+                milliseconds,
+                statistics.live_pools,
+                statistics.pools_created,
+                statistics.sets_per_pool,
+                statistics.retries,
+                statistics.clear_milliseconds
+            );
+
+            require(statistics.allocated_sets == sets_per_frame, "Allocated set count does not match!");
+
+            require(
+                statistics.live_pools <= max_pools,
+                std::format("{} live pools exceed the bound of {}!", statistics.live_pools, max_pools)
+            );
+
+            require(
+                statistics.live_pools == statistics.pools_created,
+                "Pools were created without being kept!"
+            );
+
+            if(frame == 0)
+            {
+                warm_pools = statistics.pools_created;
+
+                continue;
+            }
+
+            require(
+                statistics.pools_created == warm_pools,
+                std::format(
+                    "Frame {} created pools after the first frame ({} against {})!",
+                    frame,
+                    statistics.pools_created,
+                    warm_pools
+                )
+            );
+        }
+
+        allocator.destroyPools(device);
+
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+}
+
+int main()
+{
+    vkb::InstanceBuilder instance_builder;
+
+    const auto instance_ret {
+        instance_builder
+        .set_app_name("descriptor_stress")
+        .set_headless(true)
+        .build()
+    };
+
+    if(!instance_ret)
+    {
+        std::println(stderr, "Failed to build Vulkan Instance ({})!", instance_ret.error().message());
+
+        return EXIT_FAILURE;
+    }
+
+    vkb::PhysicalDeviceSelector physical_device_selector {instance_ret.value()};
+
+    const auto physical_device_ret {physical_device_selector.select()};
+
+    if(!physical_device_ret)
+    {
+        std::println(stderr, "Failed to find a suitable GPU!");
+
+        vkb::destroy_instance(instance_ret.value());
+
+        return EXIT_FAILURE;
+    }
+
+    vkb::DeviceBuilder device_builder {physical_device_ret.value()};
+
+    const auto device_ret {device_builder.build()};
+
+    if(!device_ret)
+    {
+        std::println(stderr, "Failed to create Vulkan logical device!");
+
+        vkb::destroy_instance(instance_ret.value());
+
+        return EXIT_FAILURE;
+    }
+
+    int exit_code {EXIT_SUCCESS};
+
+    try
+    {
+        run(device_ret.value().device);
+
+        std::println("Pool count stayed bounded over {} frames of {} sets", frame_count, sets_per_frame);
+    }
+    catch(const std::exception& exception)
+    {
+        std::println(stderr, "{}", exception.what());
+
+        exit_code = EXIT_FAILURE;
+    }
+
+    vkb::destroy_device(device_ret.value());
+    vkb::destroy_instance(instance_ret.value());
+
+    return exit_code;
+}
@@ -0,0 +1,546 @@
+#include "vkei/engine.hpp"
+#include "vkei/mesh_node.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <glm/ext/matrix_transform.hpp>
+#include <memory>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    using mdsm::vkei::Engine;
+    using mdsm::vkei::EngineSettings;
+    using mdsm::vkei::Material;
+    using mdsm::vkei::MeshAsset;
+    using mdsm::vkei::MeshNode;
+    using mdsm::vkei::MetallicRoughness;
+    using mdsm::vkei::Node;
+    using mdsm::vkei::Surface;
+    using mdsm::vkei::Vertex;
+
+    // Frame statistics keep the last 128 samples, so only the steady state is reported
+    constexpr std::size_t frame_count {512};
+
+    // Enough to push the frames that upload and diff a new scene out of the statistics
+    constexpr std::size_t scene_frame_count {160};
+
+    constexpr std::size_t width {1280};
+    constexpr std::size_t height {720};
+
+    // Mesh nodes are grouped under roots so traversal jobs get whole groups
+    constexpr std::size_t instances_per_root {1024};
+
+    void drawFrames(Engine& engine, const std::size_t count = frame_count)
+    {
+        for(std::size_t frame {}; frame < count; ++frame)
+        {
+            engine.draw();
+        }
+    }
+
+    std::shared_ptr<MeshAsset> createCube(Engine& engine)
+    {
+        std::array<Vertex, 8> vertices;
+
+        for(std::uint32_t corner {}; corner < vertices.size(); ++corner)
+        {
+            const glm::vec3 position {
+                corner & 1? .5f : -.5f,
+                corner & 2? .5f : -.5f,
+                corner & 4? .5f : -.5f
+            };
+
+            vertices[corner] = Vertex{
+                .position = position,
+                .uv_x = 0.f,
+                .normal = glm::normalize(position),
+                .uv_y = 0.f,
+                .color = glm::vec4{1.f}
+            };
+        }
+
+        std::array<std::uint32_t, 36> indices {
+            0, 2, 1, 1, 2, 3,
+            4, 5, 6, 5, 7, 6,
+            0, 1, 4, 1, 5, 4,
+            2, 6, 3, 3, 6, 7,
+            0, 4, 2, 2, 4, 6,
+            1, 3, 5, 3, 7, 5
+        };
+
+        return engine.createMesh(
+            "cube",
+            indices,
+            vertices,
+            {
+                Surface{
+                    .start_index = 0,
+                    .count = static_cast<std::uint32_t>(indices.size()),
+                    .bounds = {},
+                    .material = std::make_shared<Material>(Material{engine.getDefaultMaterial()})
+                }
+            }
+        );
+    }
+
+    // Distinct constants give every material its own descriptor set
+    std::vector<MetallicRoughness::MaterialRequest> createMaterialRequests(Engine& engine, const std::size_t count)
+    {
+        std::vector<MetallicRoughness::MaterialConstants> constants (count);
+
+        for(std::size_t material {}; material < count; ++material)
+        {
+            constants[material].color_factors = glm::vec4{
+                static_cast<float>(material) / static_cast<float>(count), 1.f, 1.f, 1.f
+            };
+            constants[material].metal_roughness_factor = glm::vec4{1.f, .5f, 0.f, 0.f};
+        }
+
+        const std::vector<MetallicRoughness::MaterialResources> resources {
+            engine.createMaterialResources(constants)
+        };
+
+        std::vector<MetallicRoughness::MaterialRequest> requests;
+
+        for(const auto& material_resources : resources)
+        {
+            requests.push_back(
+                MetallicRoughness::MaterialRequest{
+                    .pass = mdsm::vkei::MaterialPass::MainColor,
+                    .resources = material_resources
+                }
+            );
+        }
+
+        return requests;
+    }
+
+    std::vector<mdsm::vkei::MaterialInstance> createMaterials(Engine& engine, const std::size_t count)
+    {
+        return engine.writeMaterials(createMaterialRequests(engine, count));
+    }
+
+    // Copies of the mesh that share its geometry, each drawn with one of the materials
+    std::vector<std::shared_ptr<MeshAsset>> withMaterials(
+        const MeshAsset& mesh,
+        const std::span<const mdsm::vkei::MaterialInstance> materials
+    )
+    {
+        std::vector<std::shared_ptr<MeshAsset>> meshes;
+
+        for(const auto& material : materials)
+        {
+            auto copy {std::make_shared<MeshAsset>(mesh)};
+
+            for(auto& surface : copy->surfaces)
+            {
+                surface.material = std::make_shared<Material>(Material{material});
+            }
+
+            meshes.push_back(std::move(copy));
+        }
+
+        return meshes;
+    }
+
+    // Scatters instances in front of the camera, instance i draws meshes[i % meshes.size()].
+    // A spread of 1 keeps every instance inside the view, larger spreads leave most outside
+    void addInstances(
+        Engine& engine,
+        const std::span<const std::shared_ptr<MeshAsset>> meshes,
+        const std::size_t count,
+        const float spread
+    )
+    {
+        std::mt19937 generator {7};
+
+        std::uniform_real_distribution<float> unit {-1.f, 1.f};
+        std::uniform_real_distribution<float> depth {8.f, 200.f};
+
+        for(std::size_t first {}; first < count; first += instances_per_root)
+        {
+            auto root {std::make_shared<Node>()};
+
+            root->local_transform = glm::mat4{1.f};
+            root->world_transform = glm::mat4{1.f};
+
+            for(std::size_t instance {first}; instance < std::min(first + instances_per_root, count); ++instance)
+            {
+                auto node {std::make_shared<MeshNode>()};
+
+                // The camera sits at z = 5 looking down -z
+                const float distance {depth(generator)};
+
+                const glm::vec3 position {
+                    unit(generator) * distance * spread,
+                    unit(generator) * distance * spread * .5f,
+                    5.f - distance
+                };
+
+                node->mesh = meshes[instance % meshes.size()];
+                node->local_transform = glm::translate(glm::mat4{1.f}, position);
+                node->world_transform = node->local_transform;
+                node->parent = root;
+
+                root->children.push_back(std::move(node));
+            }
+
+            engine.addNode(std::format("instances_{}", first / instances_per_root), std::move(root));
+        }
+    }
+
+    // CPU time blocked in the render fence wait for every frames-in-flight setting
+    void benchmarkFramesInFlight()
+    {
+        std::println("Fence wait over the last 128 of {} headless frames:", frame_count);
+
+        for(std::size_t frames_in_flight {1}; frames_in_flight <= 4; ++frames_in_flight)
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.frames_in_flight = frames_in_flight;
+
+            Engine engine {"engine_benchmark", width, height, "", false, settings};
+
+            drawFrames(engine);
+
+            std::println(
+                "    {} in flight: wait {:.3f} ms average, {:.3f} ms max, CPU frame {:.3f} ms",
+                frames_in_flight,
+                engine.getFrameWaitStatistics().getAverage(),
+                engine.getFrameWaitStatistics().getMaximum(),
+                engine.getCpuFrameStatistics().getAverage()
+            );
+        }
+    }
+
+    // CPU time spent allocating and writing the per-frame scene descriptors with each backend
+    void benchmarkDescriptorBackends()
+    {
+        struct Backend
+        {
+            std::string_view name;
+
+            bool descriptor_buffers;
+            bool push_scene_descriptors;
+        };
+
+        constexpr Backend backends[] {
+            {"descriptor pools", false, false},
+            {"descriptor buffers", true, false},
+            {"push descriptors", false, true}
+        };
+
+        std::println("Scene descriptor allocation and write over the last 128 of {} frames:", frame_count);
+
+        for(const Backend& backend : backends)
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.descriptor_buffers = backend.descriptor_buffers;
+            settings.push_scene_descriptors = backend.push_scene_descriptors;
+
+            std::optional<Engine> engine;
+
+            // The device may lack the extension a backend needs, the others still run
+            try
+            {
+                engine.emplace("engine_benchmark", width, height, "", false, settings);
+            }
+            catch(const std::runtime_error& error)
+            {
+                std::println("    {}: skipped ({})", backend.name, error.what());
+
+                continue;
+            }
+
+            drawFrames(*engine);
+
+            std::println(
+                "    {}: {:.4f} ms average, {:.4f} ms max",
+                backend.name,
+                engine->getDescriptorWriteStatistics().getAverage(),
+                engine->getDescriptorWriteStatistics().getMaximum()
+            );
+        }
+    }
+
+    // Material set binds and recording cost of a many-material scene with and without the
+    // bindless table, where materials only change a push constant
+    void benchmarkBindlessMaterials()
+    {
+        constexpr std::size_t object_count {10'000};
+        constexpr std::size_t material_count {1000};
+
+        std::println(
+            "{} objects across {} materials over the last 128 of {} frames:",
+            object_count,
+            material_count,
+            scene_frame_count
+        );
+
+        for(const bool bindless_materials : {false, true})
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.bindless_materials = bindless_materials;
+
+            const std::string_view mode {bindless_materials? "bindless" : "per-material sets"};
+
+            std::optional<Engine> engine;
+
+            // Bindless needs descriptor indexing features the device may lack
+            try
+            {
+                engine.emplace("engine_benchmark", width, height, "", false, settings);
+            }
+            catch(const std::runtime_error& error)
+            {
+                std::println("    {}: skipped ({})", mode, error.what());
+
+                continue;
+            }
+
+            const std::shared_ptr<MeshAsset> cube {createCube(*engine)};
+
+            const std::vector<mdsm::vkei::MaterialInstance> materials {createMaterials(*engine, material_count)};
+
+            const std::vector<std::shared_ptr<MeshAsset>> meshes {withMaterials(*cube, materials)};
+
+            addInstances(*engine, meshes, object_count, 1.f);
+
+            drawFrames(*engine, scene_frame_count);
+
+            const Engine::DrawStatistics& statistics {engine->getDrawStatistics()};
+
+            std::println(
+                "    {}: {} set 1 binds, {} material index pushes, CPU frame {:.3f} ms, record {:.3f} ms",
+                mode,
+                statistics.material_set_binds,
+                statistics.push_constant_updates,
+                engine->getCpuFrameStatistics().getAverage(),
+                engine->getRecordStatistics().getAverage()
+            );
+        }
+    }
+
+    // The GPU-driven path keeps the scene resident, so CPU work per frame should not grow
+    // with the instance count. CPU work is the frame time minus the fence wait
+    void benchmarkSceneSize()
+    {
+        std::println("GPU-driven CPU cost over the last 128 of {} frames:", scene_frame_count);
+
+        for(const std::size_t instance_count : {1'000uz, 10'000uz, 100'000uz, 1'000'000uz})
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.gpu_driven = true;
+
+            Engine engine {"engine_benchmark", width, height, "", false, settings};
+
+            const std::shared_ptr<MeshAsset> cube {createCube(engine)};
+
+            addInstances(engine, std::span{&cube, 1}, instance_count, 8.f);
+
+            drawFrames(engine, scene_frame_count);
+
+            const double frame_milliseconds {engine.getCpuFrameStatistics().getAverage()};
+            const double wait_milliseconds {engine.getFrameWaitStatistics().getAverage()};
+
+            std::println(
+                "    {:7} instances: CPU work {:.3f} ms (frame {:.3f} ms, fence wait {:.3f} ms), {} objects uploaded last frame",
+                instance_count,
+                frame_milliseconds - wait_milliseconds,
+                frame_milliseconds,
+                wait_milliseconds,
+                engine.getGpuSceneStatistics().uploaded_objects
+            );
+        }
+    }
+
+    // Parallel material writes, each worker allocating from its own descriptor allocator
+    void benchmarkMaterialWrites()
+    {
+        constexpr std::size_t material_count {4096};
+        constexpr std::size_t repetitions {5};
+
+        std::println("Writing {} materials, best of {} runs:", material_count, repetitions);
+
+        for(const std::size_t worker_threads : {1uz, 4uz, 16uz})
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.worker_threads = worker_threads;
+
+            Engine engine {"engine_benchmark", width, height, "", false, settings};
+
+            const std::vector<MetallicRoughness::MaterialRequest> requests {
+                createMaterialRequests(engine, material_count)
+            };
+
+            Engine::MaterialWriteStatistics best {};
+
+            for(std::size_t repetition {}; repetition < repetitions; ++repetition)
+            {
+                engine.writeMaterials(requests);
+
+                const Engine::MaterialWriteStatistics& statistics {engine.getMaterialWriteStatistics()};
+
+                if(repetition == 0 || statistics.materials_per_second > best.materials_per_second)
+                {
+                    best = statistics;
+                }
+
+                // Nothing was drawn with them, and a cleared cache makes the next run write every set again
+                engine.releaseMaterialDescriptors();
+            }
+
+            std::println(
+                "    {:2} workers: {:.0f} materials/s ({:.3f} ms on {} threads)",
+                worker_threads,
+                best.materials_per_second,
+                best.milliseconds,
+                best.thread_count
+            );
+        }
+    }
+
+    // Binds issued against one of each per object, which is what recording cost before
+    // state sorting and redundant-bind elimination
+    void benchmarkBindCounts()
+    {
+        constexpr std::size_t object_count {10'000};
+        constexpr std::size_t material_count {50};
+
+        EngineSettings settings {};
+
+        settings.headless = true;
+
+        Engine engine {"engine_benchmark", width, height, "", false, settings};
+
+        const std::shared_ptr<MeshAsset> cube {createCube(engine)};
+
+        const std::vector<mdsm::vkei::MaterialInstance> materials {createMaterials(engine, material_count)};
+
+        const std::vector<std::shared_ptr<MeshAsset>> meshes {withMaterials(*cube, materials)};
+
+        addInstances(engine, meshes, object_count, 1.f);
+
+        drawFrames(engine, scene_frame_count);
+
+        const Engine::DrawStatistics& statistics {engine.getDrawStatistics()};
+
+        // Set 0 and set 1 per object
+        const std::size_t naive_descriptor_binds {statistics.instance_count * 2};
+
+        std::println(
+            "Binds for {} objects across {} materials ({} drawn, {} draws):",
+            object_count,
+            material_count,
+            statistics.instance_count,
+            statistics.draw_count
+        );
+
+        std::println(
+            "    pipeline: {} issued, {} skipped",
+            statistics.pipeline_binds,
+            statistics.instance_count - statistics.pipeline_binds
+        );
+
+        std::println(
+            "    descriptor set: {} issued, {} skipped",
+            statistics.descriptor_set_binds,
+            naive_descriptor_binds - statistics.descriptor_set_binds
+        );
+
+        std::println(
+            "    index buffer: {} issued, {} skipped",
+            statistics.index_buffer_binds,
+            statistics.instance_count - statistics.index_buffer_binds
+        );
+
+        std::println("    redundant binds caught while recording: {}", statistics.redundant_binds);
+    }
+
+    // Draw calls recorded for one mesh and material repeated many times, with and without
+    // merging the copies into instanced draws
+    void benchmarkInstancing()
+    {
+        constexpr std::size_t object_count {50'000};
+
+        std::println(
+            "{} copies of one mesh and material over the last 128 of {} frames:",
+            object_count,
+            scene_frame_count
+        );
+
+        for(const bool instanced_draws : {true, false})
+        {
+            EngineSettings settings {};
+
+            settings.headless = true;
+            settings.instanced_draws = instanced_draws;
+
+            Engine engine {"engine_benchmark", width, height, "", false, settings};
+
+            const std::shared_ptr<MeshAsset> cube {createCube(engine)};
+
+            addInstances(engine, std::span{&cube, 1}, object_count, 1.f);
+
+            drawFrames(engine, scene_frame_count);
+
+            const Engine::DrawStatistics& statistics {engine.getDrawStatistics()};
+
+            const double frame_milliseconds {engine.getCpuFrameStatistics().getAverage()};
+            const double wait_milliseconds {engine.getFrameWaitStatistics().getAverage()};
+
+            std::println(
+                "    instancing {}: {} draw calls for {} objects, CPU work {:.3f} ms (frame {:.3f} ms)",
+                instanced_draws? "on" : "off",
+                statistics.draw_count,
+                statistics.instance_count,
+                frame_milliseconds - wait_milliseconds,
+                frame_milliseconds
+            );
+        }
+    }
+}
+
+int main()
+{
+    try
+    {
+        benchmarkFramesInFlight();
+        benchmarkDescriptorBackends();
+        benchmarkBindlessMaterials();
+        benchmarkSceneSize();
+        benchmarkMaterialWrites();
+        benchmarkBindCounts();
+        benchmarkInstancing();
+    }
+    catch(const std::exception& exception)
+    {
+        std::println(stderr, "{}", exception.what());
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include "vkei/job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <print>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using mdsm::vkei::JobCounter;
+    using mdsm::vkei::JobSystem;
+
+    constexpr std::size_t job_count {200'000};
+    constexpr std::size_t repetitions {5};
+
+    struct Result
+    {
+        // Best of the repetitions
+        double nanoseconds_per_job;
+
+        bool complete;
+    };
+
+    // Every job only bumps a counter, so the measured time is the scheduling overhead
+    template<typename Body>
+    Result measure(Body&& body)
+    {
+        Result result {.nanoseconds_per_job = 0., .complete = true};
+
+        for(std::size_t repetition {}; repetition < repetitions; ++repetition)
+        {
+            std::atomic<std::size_t> executed {};
+
+            const auto start {std::chrono::steady_clock::now()};
+
+            body(executed);
+
+            const double nanoseconds_per_job {
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                / job_count
+            };
+
+            result.nanoseconds_per_job = repetition == 0
+                ? nanoseconds_per_job
+                : std::min(result.nanoseconds_per_job, nanoseconds_per_job);
+
+            result.complete = result.complete && executed.load() == job_count;
+        }
+
+        return result;
+    }
+
+    // One submit per job into a single counter, then a wait that helps run them
+    Result measureSubmit(JobSystem& job_system)
+    {
+        return measure(
+            [&job_system](std::atomic<std::size_t>& executed)
+            {
+                JobCounter counter;
+
+                for(std::size_t job {}; job < job_count; ++job)
+                {
+                    job_system.submit(
+                        [&executed]
+                        {
+                            executed.fetch_add(1, std::memory_order_relaxed);
+                        },
+                        &counter
+                    );
+                }
+
+                job_system.wait(counter);
+            }
+        );
+    }
+
+    // Ranges of one element, the worst case for parallelFor
+    Result measureParallelFor(JobSystem& job_system)
+    {
+        return measure(
+            [&job_system](std::atomic<std::size_t>& executed)
+            {
+                job_system.parallelFor(
+                    job_count,
+                    1,
+                    [&executed](const std::size_t begin, const std::size_t end)
+                    {
+                        executed.fetch_add(end - begin, std::memory_order_relaxed);
+                    }
+                );
+            }
+        );
+    }
+}
+
+int main()
+{
+    std::vector<std::size_t> worker_counts {1, 2, 4};
+
+    const std::size_t hardware_workers {std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1};
+
+    if(hardware_workers > worker_counts.back())
+    {
+        worker_counts.push_back(hardware_workers);
+    }
+
+    std::println("{} empty jobs, best of {} runs", job_count, repetitions);
+
+    bool complete {true};
+
+    for(const std::size_t worker_count : worker_counts)
+    {
+        JobSystem job_system {worker_count};
+
+        const Result submit {measureSubmit(job_system)};
+        const Result parallel_for {measureParallelFor(job_system)};
+
+        const JobSystem::JobStatistics statistics {job_system.getStatistics()};
+
+        std::println(
+            "{:2} workers: submit {:.1f} ns/job, parallelFor {:.1f} ns/job, {} stolen of {}",
+            worker_count,
+            submit.nanoseconds_per_job,
+            parallel_for.nanoseconds_per_job,
+            statistics.stolen_jobs,
+            statistics.executed_jobs
+        );
+
+        complete = complete && submit.complete && parallel_for.complete;
+    }
+
+    if(!complete)
+    {
+        std::println(stderr, "Some jobs did not run before their wait returned!");
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
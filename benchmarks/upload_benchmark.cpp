@@ -0,0 +1,675 @@
+#include "vkei/job_system.hpp"
+#include "vkei/types.hpp"
+#include "vkei/upload_service.hpp"
+#include "vkei/utils.hpp"
+
+#include <VkBootstrap.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <print>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// The engine owns the VMA implementation, it is not linked in here
+#define VMA_IMPLEMENTATION
+
+#include "vkei/vk_mem_alloc.h"
+
+namespace
+{
+    using mdsm::vkei::AllocatedBuffer;
+    using mdsm::vkei::AllocatedImage;
+    using mdsm::vkei::JobSystem;
+    using mdsm::vkei::TimelineSemaphore;
+    using mdsm::vkei::UploadService;
+    using mdsm::vkei::Vertex;
+    using mdsm::vkei::VulkanException;
+    using mdsm::vkei::check;
+
+    constexpr std::size_t mesh_count {5000};
+    constexpr std::size_t vertices_per_mesh {256};
+    constexpr std::size_t indices_per_mesh {768};
+
+    constexpr std::size_t texture_count {500};
+    constexpr VkExtent3D texture_extent {128, 128, 1};
+
+    constexpr VkDeviceSize vertex_size {vertices_per_mesh * sizeof(Vertex)};
+    constexpr VkDeviceSize index_size {indices_per_mesh * sizeof(std::uint32_t)};
+    constexpr VkDeviceSize texture_size {texture_extent.width * texture_extent.height * 4};
+
+    constexpr VkDeviceSize total_size {mesh_count * (vertex_size + index_size) + texture_count * texture_size};
+
+    // Same as the engine's staging ring
+    constexpr VkDeviceSize staging_capacity {64 << 20};
+
+    constexpr std::size_t repetitions {3};
+
+    constexpr std::uint64_t wait_timeout {9'999'999'999};
+
+    struct Device
+    {
+        VkDevice device;
+        VmaAllocator allocator;
+
+        VkQueue graphics_queue;
+        std::uint32_t graphics_queue_family;
+
+        VkQueue transfer_queue;
+        std::uint32_t transfer_queue_family;
+    };
+
+    // Every mesh and texture uploads the same bytes, only the copies are measured
+    struct SourceData
+    {
+        std::vector<Vertex> vertices;
+        std::vector<std::uint32_t> indices;
+        std::vector<std::byte> texels;
+    };
+
+    struct Destinations
+    {
+        std::vector<AllocatedBuffer> vertex_buffers;
+        std::vector<AllocatedBuffer> index_buffers;
+        std::vector<AllocatedImage> images;
+    };
+
+    struct Result
+    {
+        // Best of the repetitions
+        double milliseconds;
+
+        std::size_t submit_count;
+    };
+
+    SourceData createSourceData()
+    {
+        SourceData source {
+            .vertices = std::vector<Vertex>(vertices_per_mesh),
+            .indices = std::vector<std::uint32_t>(indices_per_mesh),
+            .texels = std::vector<std::byte>(texture_size)
+        };
+
+        for(std::size_t index {}; index < source.indices.size(); ++index)
+        {
+            source.indices[index] = static_cast<std::uint32_t>(index % vertices_per_mesh);
+        }
+
+        for(std::size_t texel {}; texel < source.texels.size(); ++texel)
+        {
+            source.texels[texel] = static_cast<std::byte>(texel);
+        }
+
+        return source;
+    }
+
+    AllocatedBuffer createBuffer(const Device& device, const VkDeviceSize size, const VkBufferUsageFlags usage)
+    {
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = size;
+        buffer_info.usage = usage;
+
+        VmaAllocationCreateInfo allocation_info {};
+
+        allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        AllocatedBuffer buffer;
+
+        check(
+            vmaCreateBuffer(
+                device.allocator,
+                &buffer_info,
+                &allocation_info,
+                &buffer.buffer,
+                &buffer.allocation,
+                &buffer.allocation_info
+            )
+        );
+
+        return buffer;
+    }
+
+    Destinations createDestinations(const Device& device)
+    {
+        Destinations destinations;
+
+        for(std::size_t mesh {}; mesh < mesh_count; ++mesh)
+        {
+            destinations.vertex_buffers.push_back(
+                createBuffer(
+                    device,
+                    vertex_size,
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                )
+            );
+
+            destinations.index_buffers.push_back(
+                createBuffer(
+                    device,
+                    index_size,
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+                )
+            );
+        }
+
+        for(std::size_t texture {}; texture < texture_count; ++texture)
+        {
+            AllocatedImage image {};
+
+            image.image_extent = texture_extent;
+            image.image_format = VK_FORMAT_R8G8B8A8_UNORM;
+
+            VkImageCreateInfo image_info {
+                mdsm::vkei::generateImageCreateInfo(
+                    image.image_format,
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    texture_extent
+                )
+            };
+
+            VmaAllocationCreateInfo allocation_info {};
+
+            allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            check(
+                vmaCreateImage(
+                    device.allocator, &image_info, &allocation_info, &image.image, &image.allocation, nullptr
+                )
+            );
+
+            destinations.images.push_back(image);
+        }
+
+        return destinations;
+    }
+
+    void destroyDestinations(const Device& device, const Destinations& destinations)
+    {
+        for(const auto& buffer : destinations.vertex_buffers)
+        {
+            vmaDestroyBuffer(device.allocator, buffer.buffer, buffer.allocation);
+        }
+
+        for(const auto& buffer : destinations.index_buffers)
+        {
+            vmaDestroyBuffer(device.allocator, buffer.buffer, buffer.allocation);
+        }
+
+        for(const auto& image : destinations.images)
+        {
+            vmaDestroyImage(device.allocator, image.image, image.allocation);
+        }
+    }
+
+    // Fresh destinations every repetition, so no run writes memory an earlier one already touched
+    template<typename Body>
+    Result measure(const Device& device, Body&& body)
+    {
+        Result result {};
+
+        for(std::size_t repetition {}; repetition < repetitions; ++repetition)
+        {
+            const Destinations destinations {createDestinations(device)};
+
+            const auto start {std::chrono::steady_clock::now()};
+
+            const std::size_t submit_count {body(destinations)};
+
+            const double milliseconds {
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+            };
+
+            destroyDestinations(device, destinations);
+
+            result.milliseconds = repetition == 0? milliseconds : std::min(result.milliseconds, milliseconds);
+            result.submit_count = submit_count;
+        }
+
+        return result;
+    }
+
+    // Batches the copies through the staging ring and waits once at the end
+    Result measureUploadService(const Device& device, const SourceData& source, JobSystem& job_system)
+    {
+        UploadService upload_service;
+
+        upload_service.initialize(
+            device.device,
+            device.allocator,
+            device.graphics_queue,
+            device.graphics_queue_family,
+            device.transfer_queue,
+            device.transfer_queue_family,
+            staging_capacity,
+            job_system
+        );
+
+        const Result result {
+            measure(
+                device,
+                [&](const Destinations& destinations)
+                {
+                    const std::size_t previous_submits {upload_service.getStatistics().submit_count};
+
+                    for(std::size_t mesh {}; mesh < mesh_count; ++mesh)
+                    {
+                        const UploadService::BufferUpload uploads[] {
+                            {destinations.vertex_buffers[mesh].buffer, 0, source.vertices.data(), vertex_size},
+                            {destinations.index_buffers[mesh].buffer, 0, source.indices.data(), index_size}
+                        };
+
+                        upload_service.uploadBuffers(uploads);
+                    }
+
+                    for(const auto& image : destinations.images)
+                    {
+                        upload_service.uploadImage(image.image, texture_extent, source.texels.data(), texture_size);
+                    }
+
+                    upload_service.waitIdle();
+
+                    return upload_service.getStatistics().submit_count - previous_submits;
+                }
+            )
+        };
+
+        upload_service.destroy();
+
+        return result;
+    }
+
+    void transitionImage(
+        const VkCommandBuffer command_buffer,
+        const VkImage image,
+        const VkImageLayout old_layout,
+        const VkImageLayout new_layout
+    )
+    {
+        VkImageMemoryBarrier2 barrier {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr
+        };
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = mdsm::vkei::generateImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT);
+
+        VkDependencyInfo dependency_info {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr
+        };
+
+        dependency_info.imageMemoryBarrierCount = 1;
+        dependency_info.pImageMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+    }
+
+    // A staging buffer, a graphics-queue submission and a wait for every upload, the way
+    // meshes and images were uploaded before the upload service
+    Result measureImmediateUploads(const Device& device, const SourceData& source)
+    {
+        VkCommandPoolCreateInfo pool_info {
+            mdsm::vkei::generateCommandPoolCreateInfo(
+                device.graphics_queue_family, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+            )
+        };
+
+        VkCommandPool command_pool;
+
+        check(
+            vkCreateCommandPool(device.device, &pool_info, nullptr, &command_pool)
+        );
+
+        VkCommandBufferAllocateInfo command_buffer_info {
+            mdsm::vkei::generateCommandBufferAllocateInfo(command_pool, 1)
+        };
+
+        VkCommandBuffer command_buffer;
+
+        check(
+            vkAllocateCommandBuffers(device.device, &command_buffer_info, &command_buffer)
+        );
+
+        TimelineSemaphore timeline;
+
+        timeline.initialize(device.device);
+
+        // Copies data into a new staging buffer and blocks until the recorded copy has executed
+        const auto upload {
+            [&](const void* const data, const VkDeviceSize size, const auto& record)
+            {
+                VkBufferCreateInfo buffer_info {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                    .pNext = nullptr
+                };
+
+                buffer_info.size = size;
+                buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+                VmaAllocationCreateInfo allocation_info {};
+
+                allocation_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+                allocation_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+                AllocatedBuffer staging;
+
+                check(
+                    vmaCreateBuffer(
+                        device.allocator,
+                        &buffer_info,
+                        &allocation_info,
+                        &staging.buffer,
+                        &staging.allocation,
+                        &staging.allocation_info
+                    )
+                );
+
+                std::memcpy(staging.allocation_info.pMappedData, data, size);
+
+                check(
+                    vkResetCommandBuffer(command_buffer, 0)
+                );
+
+                VkCommandBufferBeginInfo begin_info {
+                    mdsm::vkei::generateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)
+                };
+
+                check(
+                    vkBeginCommandBuffer(command_buffer, &begin_info)
+                );
+
+                record(staging.buffer);
+
+                check(
+                    vkEndCommandBuffer(command_buffer)
+                );
+
+                VkCommandBufferSubmitInfo command_buffer_submit_info {
+                    mdsm::vkei::generateCommandBufferSubmitInfo(command_buffer)
+                };
+
+                const std::uint64_t submission {timeline.reserveValue()};
+
+                const VkSemaphoreSubmitInfo signal_info {timeline.generateSignalInfo(submission)};
+
+                VkSubmitInfo2 submit_info {
+                    mdsm::vkei::generateSubmitInfo(&command_buffer_submit_info, &signal_info, nullptr)
+                };
+
+                check(
+                    vkQueueSubmit2(device.graphics_queue, 1, &submit_info, VK_NULL_HANDLE)
+                );
+
+                if(!timeline.wait(device.device, submission, wait_timeout))
+                {
+                    throw VulkanException{VK_TIMEOUT};
+                }
+
+                vmaDestroyBuffer(device.allocator, staging.buffer, staging.allocation);
+            }
+        };
+
+        const Result result {
+            measure(
+                device,
+                [&](const Destinations& destinations)
+                {
+                    std::size_t submit_count {};
+
+                    const auto copyTo {
+                        [command_buffer](const VkBuffer destination, const VkDeviceSize size)
+                        {
+                            return [=](const VkBuffer staging_buffer)
+                            {
+                                const VkBufferCopy copy {.srcOffset = 0, .dstOffset = 0, .size = size};
+
+                                vkCmdCopyBuffer(command_buffer, staging_buffer, destination, 1, &copy);
+                            };
+                        }
+                    };
+
+                    for(std::size_t mesh {}; mesh < mesh_count; ++mesh)
+                    {
+                        upload(
+                            source.vertices.data(),
+                            vertex_size,
+                            copyTo(destinations.vertex_buffers[mesh].buffer, vertex_size)
+                        );
+
+                        upload(
+                            source.indices.data(),
+                            index_size,
+                            copyTo(destinations.index_buffers[mesh].buffer, index_size)
+                        );
+
+                        submit_count += 2;
+                    }
+
+                    for(const auto& image : destinations.images)
+                    {
+                        upload(
+                            source.texels.data(),
+                            texture_size,
+                            [&](const VkBuffer staging_buffer)
+                            {
+                                transitionImage(
+                                    command_buffer,
+                                    image.image,
+                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                );
+
+                                VkBufferImageCopy copy_region {};
+
+                                copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                                copy_region.imageSubresource.layerCount = 1;
+                                copy_region.imageExtent = texture_extent;
+
+                                vkCmdCopyBufferToImage(
+                                    command_buffer,
+                                    staging_buffer,
+                                    image.image,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    1,
+                                    &copy_region
+                                );
+
+                                transitionImage(
+                                    command_buffer,
+                                    image.image,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                );
+                            }
+                        );
+
+                        ++submit_count;
+                    }
+
+                    return submit_count;
+                }
+            )
+        };
+
+        timeline.destroy(device.device);
+
+        vkDestroyCommandPool(device.device, command_pool, nullptr);
+
+        return result;
+    }
+
+    void printResult(const std::string_view name, const Result& result)
+    {
+        const double megabytes_per_second {
+            static_cast<double>(total_size) / 1e6 / (result.milliseconds / 1e3)
+        };
+
+        std::println(
+            "    {}: {:.1f} ms, {:.1f} MB/s, {} submits",
+            name,
+            result.milliseconds,
+            megabytes_per_second,
+            result.submit_count
+        );
+    }
+
+    void run(const Device& device)
+    {
+        const SourceData source {createSourceData()};
+
+        JobSystem job_system;
+
+        std::println(
+            "{} meshes and {} {}x{} textures, {:.1f} MB, best of {} runs through the {} queue:",
+            mesh_count,
+            texture_count,
+            texture_extent.width,
+            texture_extent.height,
+            static_cast<double>(total_size) / 1e6,
+            repetitions,
+            device.transfer_queue_family == device.graphics_queue_family? "graphics" : "dedicated transfer"
+        );
+
+        printResult("upload service", measureUploadService(device, source, job_system));
+        printResult("staging buffer and wait per upload", measureImmediateUploads(device, source));
+    }
+}
+
+int main()
+{
+    vkb::InstanceBuilder instance_builder;
+
+    const auto instance_ret {
+        instance_builder
+        .set_app_name("upload_benchmark")
+        .require_api_version(1, 3, 0)
+        .set_headless(true)
+        .build()
+    };
+
+    if(!instance_ret)
+    {
+        std::println(stderr, "Failed to build Vulkan Instance ({})!", instance_ret.error().message());
+
+        return EXIT_FAILURE;
+    }
+
+    VkPhysicalDeviceVulkan13Features features_13 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES
+    };
+
+    features_13.synchronization2 = true;
+
+    VkPhysicalDeviceVulkan12Features features_12 {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES
+    };
+
+    features_12.timelineSemaphore = true;
+
+    vkb::PhysicalDeviceSelector physical_device_selector {instance_ret.value()};
+
+    const auto physical_device_ret {
+        physical_device_selector
+        .set_required_features_13(features_13)
+        .set_required_features_12(features_12)
+        .set_minimum_version(1, 3)
+        .select()
+    };
+
+    if(!physical_device_ret)
+    {
+        std::println(stderr, "Failed to find a suitable GPU!");
+
+        vkb::destroy_instance(instance_ret.value());
+
+        return EXIT_FAILURE;
+    }
+
+    vkb::DeviceBuilder device_builder {physical_device_ret.value()};
+
+    const auto device_ret {device_builder.build()};
+
+    if(!device_ret)
+    {
+        std::println(stderr, "Failed to create Vulkan logical device!");
+
+        vkb::destroy_instance(instance_ret.value());
+
+        return EXIT_FAILURE;
+    }
+
+    const vkb::Device& vkb_device {device_ret.value()};
+
+    Device device {
+        .device = vkb_device.device,
+        .allocator = {},
+        .graphics_queue = vkb_device.get_queue(vkb::QueueType::graphics).value(),
+        .graphics_queue_family = vkb_device.get_queue_index(vkb::QueueType::graphics).value(),
+        .transfer_queue = {},
+        .transfer_queue_family = {}
+    };
+
+    // Uploads go through a dedicated transfer queue when there is one, like in the engine
+    if(const auto transfer_queue {vkb_device.get_dedicated_queue(vkb::QueueType::transfer)})
+    {
+        device.transfer_queue = transfer_queue.value();
+        device.transfer_queue_family = vkb_device.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+    }
+    else
+    {
+        device.transfer_queue = device.graphics_queue;
+        device.transfer_queue_family = device.graphics_queue_family;
+    }
+
+    VmaAllocatorCreateInfo allocator_info {
+        .physicalDevice = physical_device_ret.value().physical_device,
+        .device = vkb_device.device,
+        .instance = instance_ret.value().instance
+    };
+
+    int exit_code {EXIT_SUCCESS};
+
+    if(vmaCreateAllocator(&allocator_info, &device.allocator) != VK_SUCCESS)
+    {
+        std::println(stderr, "Failed to create VMA allocator!");
+
+        exit_code = EXIT_FAILURE;
+    }
+    else
+    {
+        try
+        {
+            run(device);
+        }
+        catch(const std::exception& exception)
+        {
+            std::println(stderr, "{}", exception.what());
+
+            exit_code = EXIT_FAILURE;
+        }
+
+        vmaDestroyAllocator(device.allocator);
+    }
+
+    vkb::destroy_device(vkb_device);
+    vkb::destroy_instance(instance_ret.value());
+
+    return exit_code;
+}
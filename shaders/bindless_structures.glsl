@@ -0,0 +1,19 @@
+#extension GL_EXT_nonuniform_qualifier : require
+
+#include "scene_data.glsl"
+
+struct MaterialData
+{
+    vec4 color_factors;
+    vec4 metal_roughness_factors;
+
+    uint color_texture;
+    uint metal_roughness_texture;
+};
+
+layout(set = 1, binding = 0, std430) readonly buffer MaterialBuffer
+{
+    MaterialData materials[];
+} material_buffer;
+
+layout(set = 1, binding = 1) uniform sampler2D textures[];
@@ -1,13 +1,4 @@
-layout(set = 0, binding = 0) uniform SceneData
-{
-    mat4 view;
-    mat4 proj;
-    mat4 view_proj;
-
-    vec4 ambient_color;
-    vec4 sunlight_direction;
-    vec4 sunlight_color;
-} scene_data;
+#include "scene_data.glsl"
 
 layout(set = 1, binding = 0) uniform MaterialData
 {
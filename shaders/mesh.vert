@@ -23,22 +23,29 @@ layout(buffer_reference, std430) readonly buffer VertexBuffer {
     Vertex vertices[];
 };
 
+layout(buffer_reference, std430) readonly buffer InstanceBuffer {
+    mat4 transforms[];
+};
+
 layout(push_constant) uniform constants
 {
-    mat4 render_matrix;
-
     VertexBuffer vertex_buffer;
+
+    InstanceBuffer instance_buffer;
 } push_constants;
 
 void main()
 {
     Vertex vertex = push_constants.vertex_buffer.vertices[gl_VertexIndex];
 
+    // firstInstance of each draw is the group's first transform
+    mat4 render_matrix = push_constants.instance_buffer.transforms[gl_InstanceIndex];
+
     vec4 position = vec4(vertex.position, 1.0f);
 
-    gl_Position = scene_data.view_proj * push_constants.render_matrix * position;
+    gl_Position = scene_data.view_proj * render_matrix * position;
 
-    out_color = (push_constants.render_matrix * vec4(vertex.normal, 0.f)).xyz;
+    out_color = (render_matrix * vec4(vertex.normal, 0.f)).xyz;
 
     out_color = vertex.color.xyz * material_data.color_factors.xyz;
 
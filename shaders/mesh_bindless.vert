@@ -0,0 +1,61 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+
+#include "bindless_structures.glsl"
+
+layout (location = 0) out vec3 out_normal;
+layout (location = 1) out vec3 out_color;
+layout (location = 2) out vec2 out_UV;
+layout (location = 3) flat out uint out_material;
+
+struct Vertex 
+{
+    vec3 position;
+    float uv_x;
+    vec3 normal;
+    float uv_y;
+
+    vec4 color;
+};
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer {
+    Vertex vertices[];
+};
+
+layout(buffer_reference, std430) readonly buffer InstanceBuffer {
+    mat4 transforms[];
+};
+
+layout(push_constant) uniform constants
+{
+    VertexBuffer vertex_buffer;
+
+    InstanceBuffer instance_buffer;
+
+    uint material_index;
+} push_constants;
+
+void main()
+{
+    Vertex vertex = push_constants.vertex_buffer.vertices[gl_VertexIndex];
+
+    // firstInstance of each draw is the group's first transform
+    mat4 render_matrix = push_constants.instance_buffer.transforms[gl_InstanceIndex];
+
+    vec4 position = vec4(vertex.position, 1.0f);
+
+    gl_Position = scene_data.view_proj * render_matrix * position;
+
+    out_color = (render_matrix * vec4(vertex.normal, 0.f)).xyz;
+
+    MaterialData material = material_buffer.materials[push_constants.material_index];
+
+    out_color = vertex.color.xyz * material.color_factors.xyz;
+
+    out_UV.x = vertex.uv_x;
+    out_UV.y = vertex.uv_y;
+
+    out_material = push_constants.material_index;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+
+#include "bindless_structures.glsl"
+
+layout (location = 0) out vec3 out_normal;
+layout (location = 1) out vec3 out_color;
+layout (location = 2) out vec2 out_UV;
+layout (location = 3) flat out uint out_material;
+
+struct Vertex 
+{
+    vec3 position;
+    float uv_x;
+    vec3 normal;
+    float uv_y;
+
+    vec4 color;
+};
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer {
+    Vertex vertices[];
+};
+
+struct Object
+{
+    mat4 transform;
+
+    vec4 sphere;
+
+    uint first_index;
+    uint index_count;
+
+    uint batch;
+    uint command_offset;
+
+    VertexBuffer vertex_buffer;
+    int vertex_offset;
+    uint material_index;
+};
+
+layout(buffer_reference, std430) readonly buffer ObjectBuffer {
+    Object objects[];
+};
+
+// Same layout as mesh_bindless.vert, the instance address points at the objects
+// and the material index comes from the object
+layout(push_constant) uniform constants
+{
+    VertexBuffer vertex_buffer;
+
+    ObjectBuffer object_buffer;
+} push_constants;
+
+void main()
+{
+    // firstInstance of each indirect command is the object index
+    Object object = push_constants.object_buffer.objects[gl_InstanceIndex];
+
+    Vertex vertex = object.vertex_buffer.vertices[gl_VertexIndex];
+
+    vec4 position = vec4(vertex.position, 1.0f);
+
+    gl_Position = scene_data.view_proj * object.transform * position;
+
+    out_normal = (object.transform * vec4(vertex.normal, 0.f)).xyz;
+
+    MaterialData material = material_buffer.materials[object.material_index];
+
+    out_color = vertex.color.xyz * material.color_factors.xyz;
+
+    out_UV.x = vertex.uv_x;
+    out_UV.y = vertex.uv_y;
+
+    out_material = object.material_index;
+}
@@ -0,0 +1,10 @@
+layout(set = 0, binding = 0) uniform SceneData
+{
+    mat4 view;
+    mat4 proj;
+    mat4 view_proj;
+
+    vec4 ambient_color;
+    vec4 sunlight_direction;
+    vec4 sunlight_color;
+} scene_data;
@@ -25,6 +25,8 @@ void Game::run()
 
     while(!quit)
     {
+        vulkan_engine.waitForNextFrame();
+
         while(SDL_PollEvent(&event))
         {
             if(event.type == SDL_EVENT_QUIT)
@@ -0,0 +1,199 @@
+#include "barrier_batch.hpp"
+
+namespace mdsm::vkei
+{
+    namespace
+    {
+        struct Dependency
+        {
+            VkPipelineStageFlags2 source_stages;
+            VkAccessFlags2 source_access;
+
+            bool layout_change;
+            bool needed;
+        };
+
+        Dependency resolveDependency(
+            AccessState& state, const ResourceUsageInfo& usage_info, const bool is_image
+        )
+        {
+            const bool layout_change {is_image && state.layout != usage_info.layout};
+
+            Dependency dependency {
+                .source_stages = VK_PIPELINE_STAGE_2_NONE,
+                .source_access = VK_ACCESS_2_NONE,
+                .layout_change = layout_change,
+                .needed = false
+            };
+
+            if(usage_info.writes || layout_change)
+            {
+                // Write-after-write needs availability, write-after-read only an execution dependency
+                dependency.source_stages = state.write_stages | state.read_stages;
+                dependency.source_access = state.write_access;
+            }
+            else if(state.write_stages && (usage_info.stage_mask & ~state.read_stages))
+            {
+                dependency.source_stages = state.write_stages;
+                dependency.source_access = state.write_access;
+            }
+
+            dependency.needed = layout_change || dependency.source_stages;
+
+            if(usage_info.writes)
+            {
+                state.write_stages = usage_info.stage_mask;
+                state.write_access = usage_info.access_mask;
+                state.read_stages = VK_PIPELINE_STAGE_2_NONE;
+            }
+            else if(layout_change)
+            {
+                // Later readers in other stages still have to wait for the transition itself
+                state.write_stages = usage_info.stage_mask;
+                state.write_access = VK_ACCESS_2_NONE;
+                state.read_stages = usage_info.stage_mask;
+            }
+            else
+            {
+                state.read_stages |= usage_info.stage_mask;
+            }
+
+            return dependency;
+        }
+    }
+
+    void BarrierBatch::useImage(
+        AccessState& state,
+        const VkImage image,
+        const VkImageAspectFlags aspect_mask,
+        const ResourceUsage usage
+    )
+    {
+        const ResourceUsageInfo usage_info {getResourceUsageInfo(usage)};
+
+        const VkImageLayout old_layout {state.layout};
+
+        const Dependency dependency {resolveDependency(state, usage_info, true)};
+
+        state.layout = usage_info.layout;
+
+        if(!dependency.needed)
+        {
+            return;
+        }
+
+        VkImageMemoryBarrier2 barrier {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr
+        };
+
+        barrier.srcStageMask = dependency.source_stages;
+        barrier.srcAccessMask = dependency.source_access;
+        barrier.dstStageMask = usage_info.stage_mask;
+        barrier.dstAccessMask = usage_info.access_mask;
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = usage_info.layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = aspect_mask;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+        addImageBarrier(barrier);
+    }
+
+    void BarrierBatch::useBuffer(AccessState& state, const VkBuffer buffer, const ResourceUsage usage)
+    {
+        const ResourceUsageInfo usage_info {getResourceUsageInfo(usage)};
+
+        const Dependency dependency {resolveDependency(state, usage_info, false)};
+
+        if(!dependency.needed)
+        {
+            return;
+        }
+
+        VkBufferMemoryBarrier2 barrier {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+            .pNext = nullptr
+        };
+
+        barrier.srcStageMask = dependency.source_stages;
+        barrier.srcAccessMask = dependency.source_access;
+        barrier.dstStageMask = usage_info.stage_mask;
+        barrier.dstAccessMask = usage_info.access_mask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        addBufferBarrier(barrier);
+    }
+
+    void BarrierBatch::addImageBarrier(const VkImageMemoryBarrier2& barrier)
+    {
+        image_barriers.push_back(barrier);
+    }
+
+    void BarrierBatch::addBufferBarrier(const VkBufferMemoryBarrier2& barrier)
+    {
+        buffer_barriers.push_back(barrier);
+    }
+
+    void BarrierBatch::flush(const VkCommandBuffer command_buffer)
+    {
+        if(isEmpty())
+        {
+            return;
+        }
+
+        VkDependencyInfo dependency_info {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr
+        };
+
+        dependency_info.imageMemoryBarrierCount = static_cast<std::uint32_t>(image_barriers.size());
+        dependency_info.pImageMemoryBarriers = image_barriers.data();
+        dependency_info.bufferMemoryBarrierCount = static_cast<std::uint32_t>(buffer_barriers.size());
+        dependency_info.pBufferMemoryBarriers = buffer_barriers.data();
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+
+        ++flush_count;
+
+        image_barrier_count += image_barriers.size();
+        buffer_barrier_count += buffer_barriers.size();
+
+        clear();
+    }
+
+    void BarrierBatch::clear()
+    {
+        image_barriers.clear();
+        buffer_barriers.clear();
+    }
+
+    bool BarrierBatch::isEmpty() const
+    {
+        return image_barriers.empty() && buffer_barriers.empty();
+    }
+
+    std::size_t BarrierBatch::getFlushCount() const
+    {
+        return flush_count;
+    }
+
+    std::size_t BarrierBatch::getImageBarrierCount() const
+    {
+        return image_barrier_count;
+    }
+
+    std::size_t BarrierBatch::getBufferBarrierCount() const
+    {
+        return buffer_barrier_count;
+    }
+}
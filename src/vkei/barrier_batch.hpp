@@ -0,0 +1,59 @@
+#pragma once
+
+#include "resource_usage.hpp"
+#include <cstddef>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // What later accesses to an image or buffer have to synchronize against
+    struct AccessState
+    {
+        // Ignored for buffers
+        VkImageLayout layout {VK_IMAGE_LAYOUT_UNDEFINED};
+
+        // Stages whose writes, or layout transition, later accesses must wait on
+        VkPipelineStageFlags2 write_stages {};
+        VkAccessFlags2 write_access {};
+
+        // Stages that already read, or were made visible, since the last write
+        VkPipelineStageFlags2 read_stages {};
+    };
+
+    class BarrierBatch
+    {
+        public:
+            // Queues whatever barrier the usage needs against the current state, then updates it
+            void useImage(
+                AccessState& state,
+                const VkImage image,
+                const VkImageAspectFlags aspect_mask,
+                const ResourceUsage usage
+            );
+
+            void useBuffer(AccessState& state, const VkBuffer buffer, const ResourceUsage usage);
+
+            void addImageBarrier(const VkImageMemoryBarrier2& barrier);
+            void addBufferBarrier(const VkBufferMemoryBarrier2& barrier);
+
+            // Records every queued barrier with a single vkCmdPipelineBarrier2
+            void flush(const VkCommandBuffer command_buffer);
+
+            void clear();
+
+            bool isEmpty() const;
+
+            std::size_t getFlushCount() const;
+            std::size_t getImageBarrierCount() const;
+            std::size_t getBufferBarrierCount() const;
+
+        private:
+            std::vector<VkImageMemoryBarrier2> image_barriers;
+            std::vector<VkBufferMemoryBarrier2> buffer_barriers;
+
+            std::size_t flush_count {};
+            std::size_t image_barrier_count {};
+            std::size_t buffer_barrier_count {};
+    };
+}
@@ -0,0 +1,231 @@
+#include "bindless_table.hpp"
+#include "descriptor_layout_builder.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <format>
+#include <stdexcept>
+
+namespace mdsm::vkei
+{
+    void BindlessTable::initialize(
+        const VkDevice device,
+        const VmaAllocator allocator,
+        const std::uint32_t texture_capacity,
+        const std::uint32_t material_capacity
+    )
+    {
+        this->device = device;
+        this->allocator = allocator;
+        this->texture_capacity = texture_capacity;
+        this->material_capacity = material_capacity;
+
+        // The texture array may be written after the set is bound, empty slots are never read
+        const std::array<VkDescriptorBindingFlags, 2> binding_flags {
+            0,
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+            | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT
+        };
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        binding_flags_info.bindingCount = static_cast<std::uint32_t>(binding_flags.size());
+        binding_flags_info.pBindingFlags = binding_flags.data();
+
+        DescriptorLayoutBuilder layout_builder;
+
+        layout_builder.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        layout_builder.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, texture_capacity);
+
+        layout = layout_builder.build(
+            device,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            &binding_flags_info,
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT
+        );
+
+        const std::array<VkDescriptorPoolSize, 2> pool_sizes {
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, texture_capacity}
+        };
+
+        VkDescriptorPoolCreateInfo pool_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        pool_info.maxSets = 1;
+        pool_info.poolSizeCount = static_cast<std::uint32_t>(pool_sizes.size());
+        pool_info.pPoolSizes = pool_sizes.data();
+
+        check(
+            vkCreateDescriptorPool(device, &pool_info, nullptr, &pool)
+        );
+
+        VkDescriptorSetVariableDescriptorCountAllocateInfo variable_count_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+            .pNext = nullptr
+        };
+
+        variable_count_info.descriptorSetCount = 1;
+        variable_count_info.pDescriptorCounts = &texture_capacity;
+
+        VkDescriptorSetAllocateInfo allocate_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = &variable_count_info
+        };
+
+        allocate_info.descriptorPool = pool;
+        allocate_info.descriptorSetCount = 1;
+        allocate_info.pSetLayouts = &layout;
+
+        check(
+            vkAllocateDescriptorSets(device, &allocate_info, &descriptor_set)
+        );
+
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = material_capacity * sizeof(MaterialRecord);
+        buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+        VmaAllocationCreateInfo allocation_create_info {};
+
+        allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo allocation_info;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &buffer_info,
+                &allocation_create_info,
+                &material_buffer,
+                &material_allocation,
+                &allocation_info
+            )
+        );
+
+        materials = reinterpret_cast<MaterialRecord*>(allocation_info.pMappedData);
+
+        writer.clear();
+
+        writer.writeBuffer(
+            0,
+            material_buffer,
+            buffer_info.size,
+            0,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+        );
+
+        writer.updateDescriptorSet(device, descriptor_set);
+    }
+
+    void BindlessTable::destroy()
+    {
+        vmaDestroyBuffer(allocator, material_buffer, material_allocation);
+
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+
+        texture_indices.clear();
+
+        texture_count = 0;
+        material_count = 0;
+    }
+
+    std::uint32_t BindlessTable::addTexture(const VkImageView image_view, const VkSampler sampler)
+    {
+        std::lock_guard lock {mutex};
+
+        if(
+            const auto existing {texture_indices.find({image_view, sampler})};
+            existing != texture_indices.end()
+        )
+        {
+            ++reused_textures;
+
+            return existing->second;
+        }
+
+        if(texture_count == texture_capacity)
+        {
+            throw std::runtime_error{
+                std::format("Bindless texture table is full ({} textures)!", texture_capacity)
+            };
+        }
+
+        const std::uint32_t index {texture_count++};
+
+        writer.clear();
+
+        writer.writeImage(
+            1,
+            image_view,
+            sampler,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            index
+        );
+
+        writer.updateDescriptorSet(device, descriptor_set);
+
+        texture_indices.emplace(std::pair{image_view, sampler}, index);
+
+        return index;
+    }
+
+    std::uint32_t BindlessTable::addMaterial(const MaterialRecord& material)
+    {
+        std::lock_guard lock {mutex};
+
+        if(material_count == material_capacity)
+        {
+            throw std::runtime_error{
+                std::format("Bindless material table is full ({} materials)!", material_capacity)
+            };
+        }
+
+        const std::uint32_t index {material_count++};
+
+        materials[index] = material;
+
+        check(
+            vmaFlushAllocation(
+                allocator, material_allocation, index * sizeof(MaterialRecord), sizeof(MaterialRecord)
+            )
+        );
+
+        return index;
+    }
+
+    VkDescriptorSetLayout BindlessTable::getLayout() const
+    {
+        return layout;
+    }
+
+    VkDescriptorSet BindlessTable::getDescriptorSet() const
+    {
+        return descriptor_set;
+    }
+
+    BindlessTable::TableStatistics BindlessTable::getStatistics() const
+    {
+        return TableStatistics{
+            .texture_count = texture_count,
+            .texture_capacity = texture_capacity,
+            .material_count = material_count,
+            .material_capacity = material_capacity,
+            .reused_textures = reused_textures
+        };
+    }
+}
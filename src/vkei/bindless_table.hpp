@@ -0,0 +1,101 @@
+#pragma once
+
+#include "descriptor_writer.hpp"
+#include "vk_mem_alloc.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // One descriptor set shared by every material, set 1 of the bindless pipelines.
+    // Binding 0 is a storage buffer of MaterialRecords, binding 1 a variable-count array
+    // of sampled textures, shaders pick their entries through the material index
+    class BindlessTable
+    {
+        public:
+            // Matches MaterialData in bindless_structures.glsl (std430)
+            struct MaterialRecord
+            {
+                glm::vec4 color_factors;
+                glm::vec4 metal_roughness_factors;
+
+                // Indices into the texture array
+                std::uint32_t color_texture;
+                std::uint32_t metal_roughness_texture;
+
+                std::uint32_t padding[2];
+            };
+
+            static_assert(sizeof(MaterialRecord) == 48);
+
+            struct TableStatistics
+            {
+                std::uint32_t texture_count;
+                std::uint32_t texture_capacity;
+
+                std::uint32_t material_count;
+                std::uint32_t material_capacity;
+
+                // Textures registered again that reused an existing slot
+                std::size_t reused_textures;
+            };
+
+            BindlessTable() = default;
+
+            BindlessTable(const BindlessTable&) = delete;
+            BindlessTable& operator=(const BindlessTable&) = delete;
+
+            void initialize(
+                const VkDevice device,
+                const VmaAllocator allocator,
+                const std::uint32_t texture_capacity,
+                const std::uint32_t material_capacity
+            );
+
+            void destroy();
+
+            // Returns the texture index, each view and sampler pair gets a single slot.
+            // Slots are written while earlier frames may still be in flight, they never read new slots.
+            // Both adds are thread-safe
+            std::uint32_t addTexture(const VkImageView image_view, const VkSampler sampler);
+
+            // Returns the material index
+            std::uint32_t addMaterial(const MaterialRecord& material);
+
+            VkDescriptorSetLayout getLayout() const;
+            VkDescriptorSet getDescriptorSet() const;
+
+            TableStatistics getStatistics() const;
+
+        private:
+            VkDevice device {};
+            VmaAllocator allocator {};
+
+            VkDescriptorSetLayout layout {};
+            VkDescriptorPool pool {};
+            VkDescriptorSet descriptor_set {};
+
+            VkBuffer material_buffer {};
+            VmaAllocation material_allocation {};
+
+            MaterialRecord* materials {};
+
+            std::uint32_t texture_capacity {};
+            std::uint32_t material_capacity {};
+
+            std::uint32_t texture_count {};
+            std::uint32_t material_count {};
+
+            std::size_t reused_textures {};
+
+            std::map<std::pair<VkImageView, VkSampler>, std::uint32_t> texture_indices;
+
+            DescriptorWriter writer;
+
+            std::mutex mutex;
+    };
+}
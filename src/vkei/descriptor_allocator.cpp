@@ -1,4 +1,6 @@
 #include "descriptor_allocator.hpp"
+#include "utils.hpp"
+#include <chrono>
 #include <format>
 #include <vulkan/vk_enum_string_helper.h>
 #include <vulkan/vulkan_core.h>
@@ -19,12 +21,20 @@ namespace mdsm::vkei
 
     VkDescriptorPool DescriptorAllocator::getPool(const VkDevice device)
     {
-        VkDescriptorPool new_pool;
-    
         if(ready_pools.size())
         {
-            new_pool = ready_pools.back();
+            const VkDescriptorPool ready_pool {ready_pools.back()};
+
             ready_pools.pop_back();
+
+            return ready_pool;
+        }
+
+        VkDescriptorPool new_pool {recycler? recycler->acquire() : VK_NULL_HANDLE};
+    
+        if(new_pool)
+        {
+            ++recycled_pools;
         }
         else 
         {
@@ -70,9 +80,13 @@ namespace mdsm::vkei
     
         VkDescriptorPool new_pool;
     
-        vkCreateDescriptorPool(
-            device, &pool_info, nullptr, &new_pool
+        check(
+            vkCreateDescriptorPool(
+                device, &pool_info, nullptr, &new_pool
+            )
         );
+
+        ++pools_created;
     
         return new_pool;
     }
@@ -80,9 +94,12 @@ namespace mdsm::vkei
     void DescriptorAllocator::initialize(
         const VkDevice device,
         const std::uint32_t max_sets,
-        const std::span<PoolSizeRatio> pool_ratios
+        const std::span<PoolSizeRatio> pool_ratios,
+        DescriptorPoolRecycler* const recycler
     )
     {
+        this->recycler = recycler;
+
         ratios.clear();
     
         for(const auto ratio: pool_ratios)
@@ -90,9 +107,16 @@ namespace mdsm::vkei
             ratios.push_back(ratio);
         }
     
-        VkDescriptorPool new_pool {
-            createPool(device, max_sets, pool_ratios)
-        };
+        VkDescriptorPool new_pool {recycler? recycler->acquire() : VK_NULL_HANDLE};
+
+        if(new_pool)
+        {
+            ++recycled_pools;
+        }
+        else
+        {
+            new_pool = createPool(device, max_sets, pool_ratios);
+        }
     
         sets_per_pool = max_sets * sets_per_pool_grow_factor;
     
@@ -101,6 +125,8 @@ namespace mdsm::vkei
     
     void DescriptorAllocator::clearPools(const VkDevice device)
     {
+        const auto clear_start {std::chrono::steady_clock::now()};
+
         for(const auto pool: ready_pools)
         {
             vkResetDescriptorPool(device, pool, 0);
@@ -113,6 +139,12 @@ namespace mdsm::vkei
         }
     
         full_pools.clear();
+
+        allocated_sets = 0;
+
+        clear_milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - clear_start
+        ).count();
     }
     
     void DescriptorAllocator::destroyPools(const VkDevice device)
@@ -132,7 +164,24 @@ namespace mdsm::vkei
         full_pools.clear();
     }
     
-    
+    void DescriptorAllocator::releasePools(const VkDevice device)
+    {
+        if(!recycler)
+        {
+            destroyPools(device);
+
+            return;
+        }
+
+        recycler->recycle(device, ready_pools);
+        recycler->recycle(device, full_pools);
+
+        ready_pools.clear();
+        full_pools.clear();
+
+        allocated_sets = 0;
+    }
+
     VkDescriptorSet DescriptorAllocator::allocate(
         const VkDevice device,
         const VkDescriptorSetLayout layout,
@@ -143,7 +192,7 @@ namespace mdsm::vkei
     
         VkDescriptorSetAllocateInfo allocate_info {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .pNext = nullptr
+            .pNext = p_next
         };
     
         allocate_info.descriptorPool = pool_to_use;
@@ -156,9 +205,11 @@ namespace mdsm::vkei
             vkAllocateDescriptorSets(device, &allocate_info, &descriptor_set)
         };
     
-        if(result == VK_ERROR_OUT_OF_POOL_MEMORY || VK_ERROR_FRAGMENTED_POOL)
+        if(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
         {
             full_pools.push_back(pool_to_use);
+
+            ++retries;
             
             pool_to_use = getPool(device);
             allocate_info.descriptorPool = pool_to_use;
@@ -173,9 +224,28 @@ namespace mdsm::vkei
                 throw DescriptorSetAllocationFailed{result};
             }
         }
+        else if(result != VK_SUCCESS)
+        {
+            throw DescriptorSetAllocationFailed{result};
+        }
     
         ready_pools.push_back(pool_to_use);
+
+        ++allocated_sets;
     
         return descriptor_set;
+    }
+
+    DescriptorAllocator::AllocatorStatistics DescriptorAllocator::getStatistics() const
+    {
+        return AllocatorStatistics{
+            .pools_created = pools_created,
+            .live_pools = ready_pools.size() + full_pools.size(),
+            .sets_per_pool = sets_per_pool,
+            .allocated_sets = allocated_sets,
+            .retries = retries,
+            .recycled_pools = recycled_pools,
+            .clear_milliseconds = clear_milliseconds
+        };
     }    
 }
\ No newline at end of file
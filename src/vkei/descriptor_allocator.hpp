@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include "descriptor_pool_recycler.hpp"
 #include <span>
 #include <stdexcept>
 #include <vector>
@@ -17,6 +19,27 @@ namespace mdsm::vkei
                 float ratio;
             };
 
+            struct AllocatorStatistics
+            {
+                std::size_t pools_created;
+                std::size_t live_pools;
+
+                // Capacity of the next pool that gets created
+                std::uint32_t sets_per_pool;
+
+                // Since the last clearPools
+                std::size_t allocated_sets;
+
+                // Allocations that found their pool exhausted and moved on to another one
+                std::size_t retries;
+
+                // Pools taken from the recycler instead of created
+                std::size_t recycled_pools;
+
+                // CPU time of the last clearPools
+                double clear_milliseconds;
+            };
+
             class DescriptorSetAllocationFailed : public std::runtime_error
             {
                 public:
@@ -30,16 +53,22 @@ namespace mdsm::vkei
             DescriptorAllocator(const DescriptorAllocator&) = delete;
             DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
 
+            // Allocators are not thread-safe, give each thread its own and share pools through
+            // the recycler
             void initialize(
                 const VkDevice device,
                 const std::uint32_t initial_sets,
-                const std::span<PoolSizeRatio> pool_ratios
+                const std::span<PoolSizeRatio> pool_ratios,
+                DescriptorPoolRecycler* const recycler = nullptr
             );
 
             void clearPools(const VkDevice device);
 
             void destroyPools(const VkDevice device);
 
+            // Hands every pool to the recycler, sets allocated from them must no longer be in use
+            void releasePools(const VkDevice device);
+
             VkDescriptorSet allocate(
                 const VkDevice device,
                 const VkDescriptorSetLayout layout,
@@ -54,6 +83,8 @@ namespace mdsm::vkei
                 const std::span<PoolSizeRatio> pool_ratios
             );
 
+            AllocatorStatistics getStatistics() const;
+
         private:   
             const std::size_t max_sets_per_pool {4092};
             const double sets_per_pool_grow_factor {1.5};
@@ -62,6 +93,15 @@ namespace mdsm::vkei
             std::vector<VkDescriptorPool> full_pools;
             std::vector<VkDescriptorPool> ready_pools;
 
+            DescriptorPoolRecycler* recycler {};
+
             std::uint32_t sets_per_pool;
+
+            std::size_t pools_created {};
+            std::size_t allocated_sets {};
+            std::size_t retries {};
+            std::size_t recycled_pools {};
+
+            double clear_milliseconds {};
     };
 }
\ No newline at end of file
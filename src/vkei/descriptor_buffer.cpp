@@ -0,0 +1,174 @@
+#include "descriptor_buffer.hpp"
+#include "utils.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace mdsm::vkei
+{
+    DescriptorBufferFunctions loadDescriptorBufferFunctions(const VkDevice device)
+    {
+        const auto load {
+            [device]<typename Function>(Function& function, const char* const name)
+            {
+                function = reinterpret_cast<Function>(vkGetDeviceProcAddr(device, name));
+
+                if(!function)
+                {
+                    throw std::runtime_error{std::format("Failed to load {}!", name)};
+                }
+            }
+        };
+
+        DescriptorBufferFunctions functions;
+
+        load(functions.get_layout_size, "vkGetDescriptorSetLayoutSizeEXT");
+        load(functions.get_binding_offset, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+        load(functions.get_descriptor, "vkGetDescriptorEXT");
+        load(functions.cmd_bind_buffers, "vkCmdBindDescriptorBuffersEXT");
+        load(functions.cmd_set_offsets, "vkCmdSetDescriptorBufferOffsetsEXT");
+
+        return functions;
+    }
+
+    void DescriptorBuffer::initialize(
+        const VkDevice device,
+        const VmaAllocator allocator,
+        const DescriptorBufferFunctions& functions,
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties,
+        const VkDeviceSize capacity,
+        const VkBufferUsageFlags usage
+    )
+    {
+        this->device = device;
+        this->allocator = allocator;
+        this->functions = &functions;
+        this->properties = properties;
+        this->properties.pNext = nullptr;
+        this->capacity = capacity;
+        this->usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = capacity;
+        buffer_info.usage = this->usage;
+
+        VmaAllocationCreateInfo allocation_create_info {};
+
+        allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo allocation_info;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &buffer_info,
+                &allocation_create_info,
+                &buffer,
+                &allocation,
+                &allocation_info
+            )
+        );
+
+        data = reinterpret_cast<std::byte*>(allocation_info.pMappedData);
+
+        VkBufferDeviceAddressInfo device_address_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr
+        };
+
+        device_address_info.buffer = buffer;
+
+        address = vkGetBufferDeviceAddress(device, &device_address_info);
+
+        head = 0;
+        allocation_count = 0;
+    }
+
+    void DescriptorBuffer::destroy()
+    {
+        vmaDestroyBuffer(allocator, buffer, allocation);
+
+        head = 0;
+        allocation_count = 0;
+    }
+
+    DescriptorBuffer::Allocation DescriptorBuffer::allocate(const VkDescriptorSetLayout layout)
+    {
+        VkDeviceSize size;
+
+        functions->get_layout_size(device, layout, &size);
+
+        const VkDeviceSize alignment {properties.descriptorBufferOffsetAlignment};
+
+        std::lock_guard lock {mutex};
+
+        const VkDeviceSize offset {(head + alignment - 1) / alignment * alignment};
+
+        if(offset + size > capacity)
+        {
+            throw std::runtime_error{
+                std::format("Descriptor buffer is full ({} of {} bytes used)!", head, capacity)
+            };
+        }
+
+        head = offset + size;
+
+        ++allocation_count;
+
+        return Allocation{
+            .offset = offset,
+            .size = size,
+            .data = data + offset
+        };
+    }
+
+    void DescriptorBuffer::flush(const Allocation& written)
+    {
+        check(
+            vmaFlushAllocation(allocator, allocation, written.offset, written.size)
+        );
+    }
+
+    void DescriptorBuffer::reset()
+    {
+        head = 0;
+        allocation_count = 0;
+    }
+
+    VkDescriptorBufferBindingInfoEXT DescriptorBuffer::getBindingInfo() const
+    {
+        VkDescriptorBufferBindingInfoEXT binding_info {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .pNext = nullptr
+        };
+
+        binding_info.address = address;
+        binding_info.usage = usage;
+
+        return binding_info;
+    }
+
+    const DescriptorBufferFunctions& DescriptorBuffer::getFunctions() const
+    {
+        return *functions;
+    }
+
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& DescriptorBuffer::getProperties() const
+    {
+        return properties;
+    }
+
+    DescriptorBuffer::BufferStatistics DescriptorBuffer::getStatistics() const
+    {
+        return BufferStatistics{
+            .capacity = capacity,
+            .used_bytes = head,
+            .allocation_count = allocation_count
+        };
+    }
+}
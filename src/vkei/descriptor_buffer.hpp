@@ -0,0 +1,102 @@
+#pragma once
+
+#include "vk_mem_alloc.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // VK_EXT_descriptor_buffer entry points, not exported by the loader
+    struct DescriptorBufferFunctions
+    {
+        PFN_vkGetDescriptorSetLayoutSizeEXT get_layout_size;
+        PFN_vkGetDescriptorSetLayoutBindingOffsetEXT get_binding_offset;
+        PFN_vkGetDescriptorEXT get_descriptor;
+
+        PFN_vkCmdBindDescriptorBuffersEXT cmd_bind_buffers;
+        PFN_vkCmdSetDescriptorBufferOffsetsEXT cmd_set_offsets;
+    };
+
+    DescriptorBufferFunctions loadDescriptorBufferFunctions(const VkDevice device);
+
+    // Host-visible buffer that descriptors are written into directly, sets are
+    // linearly suballocated and bound by offset instead of allocated from pools
+    class DescriptorBuffer
+    {
+        public:
+            struct Allocation
+            {
+                VkDeviceSize offset;
+                VkDeviceSize size;
+
+                std::byte* data;
+            };
+
+            struct BufferStatistics
+            {
+                VkDeviceSize capacity;
+                VkDeviceSize used_bytes;
+
+                // Since the last reset
+                std::size_t allocation_count;
+            };
+
+            DescriptorBuffer() = default;
+
+            DescriptorBuffer(const DescriptorBuffer&) = delete;
+            DescriptorBuffer& operator=(const DescriptorBuffer&) = delete;
+
+            // Usage must hold the resource and/or sampler descriptor buffer bits the layouts need
+            void initialize(
+                const VkDevice device,
+                const VmaAllocator allocator,
+                const DescriptorBufferFunctions& functions,
+                const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties,
+                const VkDeviceSize capacity,
+                const VkBufferUsageFlags usage
+            );
+
+            void destroy();
+
+            // Room for every binding of the layout, throws when the buffer is full. Thread-safe,
+            // threads write disjoint ranges
+            Allocation allocate(const VkDescriptorSetLayout layout);
+
+            void flush(const Allocation& allocation);
+
+            // Only once the GPU is done with every allocation
+            void reset();
+
+            VkDescriptorBufferBindingInfoEXT getBindingInfo() const;
+
+            const DescriptorBufferFunctions& getFunctions() const;
+            const VkPhysicalDeviceDescriptorBufferPropertiesEXT& getProperties() const;
+
+            BufferStatistics getStatistics() const;
+
+        private:
+            VkDevice device {};
+            VmaAllocator allocator {};
+
+            const DescriptorBufferFunctions* functions {};
+
+            VkPhysicalDeviceDescriptorBufferPropertiesEXT properties {};
+
+            VkBuffer buffer {};
+            VmaAllocation allocation {};
+
+            std::byte* data {};
+
+            VkDeviceAddress address {};
+            VkBufferUsageFlags usage {};
+
+            VkDeviceSize capacity {};
+            VkDeviceSize head {};
+
+            std::size_t allocation_count {};
+
+            std::mutex mutex;
+    };
+}
@@ -20,12 +20,16 @@ namespace mdsm::vkei
     {
     }
 
-    void DescriptorLayoutBuilder::addBinding(const std::uint32_t binding, const VkDescriptorType type)
+    void DescriptorLayoutBuilder::addBinding(
+        const std::uint32_t binding,
+        const VkDescriptorType type,
+        const std::uint32_t descriptor_count
+    )
     {
         VkDescriptorSetLayoutBinding new_bind {};
     
         new_bind.binding = binding;
-        new_bind.descriptorCount = 1;
+        new_bind.descriptorCount = descriptor_count;
         new_bind.descriptorType = type;
     
         bindings.push_back(new_bind);
@@ -50,7 +54,7 @@ namespace mdsm::vkei
     
         VkDescriptorSetLayoutCreateInfo info {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .pNext = nullptr
+            .pNext = p_next
         };
     
         info.pBindings = bindings.data();
@@ -73,5 +77,12 @@ namespace mdsm::vkei
     
         return set;
     }
-}
 
+    VkDescriptorSetLayout DescriptorLayoutBuilder::buildPushDescriptorLayout(
+        const VkDevice device,
+        const VkShaderStageFlags shader_stages
+    )
+    {
+        return build(device, shader_stages, nullptr, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT);
+    }
+}
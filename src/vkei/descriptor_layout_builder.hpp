@@ -24,7 +24,11 @@ namespace mdsm::vkei
             DescriptorLayoutBuilder(const DescriptorLayoutBuilder&) = delete;
             DescriptorLayoutBuilder& operator=(const DescriptorLayoutBuilder&) = delete;
 
-            void addBinding(const std::uint32_t binding, const VkDescriptorType type);
+            void addBinding(
+                const std::uint32_t binding,
+                const VkDescriptorType type,
+                const std::uint32_t descriptor_count = 1
+            );
 
             void clear();
 
@@ -35,6 +39,12 @@ namespace mdsm::vkei
                 const VkDescriptorSetLayoutCreateFlags flags = {}
             );
 
+            // Sets of the layout are never allocated, they are pushed into command buffers
+            VkDescriptorSetLayout buildPushDescriptorLayout(
+                const VkDevice device,
+                const VkShaderStageFlags shader_stages
+            );
+
         private:
             std::vector<VkDescriptorSetLayoutBinding> bindings;
     };
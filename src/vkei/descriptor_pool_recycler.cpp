@@ -0,0 +1,65 @@
+#include "descriptor_pool_recycler.hpp"
+#include "utils.hpp"
+
+namespace mdsm::vkei
+{
+    void DescriptorPoolRecycler::recycle(
+        const VkDevice device, const std::span<const VkDescriptorPool> pools
+    )
+    {
+        // Reset outside the lock, the pools are owned by the caller until handed over
+        for(const auto pool : pools)
+        {
+            check(
+                vkResetDescriptorPool(device, pool, 0)
+            );
+        }
+
+        std::lock_guard lock {mutex};
+
+        idle_pools.insert(idle_pools.end(), pools.begin(), pools.end());
+
+        recycled_pools += pools.size();
+    }
+
+    VkDescriptorPool DescriptorPoolRecycler::acquire()
+    {
+        std::lock_guard lock {mutex};
+
+        if(idle_pools.empty())
+        {
+            return VK_NULL_HANDLE;
+        }
+
+        const VkDescriptorPool pool {idle_pools.back()};
+
+        idle_pools.pop_back();
+
+        ++reused_pools;
+
+        return pool;
+    }
+
+    void DescriptorPoolRecycler::destroyPools(const VkDevice device)
+    {
+        std::lock_guard lock {mutex};
+
+        for(const auto pool : idle_pools)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+
+        idle_pools.clear();
+    }
+
+    DescriptorPoolRecycler::RecyclerStatistics DescriptorPoolRecycler::getStatistics() const
+    {
+        std::lock_guard lock {mutex};
+
+        return RecyclerStatistics{
+            .recycled_pools = recycled_pools,
+            .reused_pools = reused_pools,
+            .idle_pools = idle_pools.size()
+        };
+    }
+}
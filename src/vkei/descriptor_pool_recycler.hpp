@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Reset descriptor pools shared between DescriptorAllocators, so pools released by one
+    // thread are reused by another instead of created again. Every allocator attached to a
+    // recycler must use the same pool size ratios
+    class DescriptorPoolRecycler
+    {
+        public:
+            struct RecyclerStatistics
+            {
+                std::size_t recycled_pools;
+                std::size_t reused_pools;
+
+                std::size_t idle_pools;
+            };
+
+            DescriptorPoolRecycler() = default;
+
+            DescriptorPoolRecycler(const DescriptorPoolRecycler&) = delete;
+            DescriptorPoolRecycler& operator=(const DescriptorPoolRecycler&) = delete;
+
+            // Resets the pools, sets allocated from them must no longer be in use
+            void recycle(const VkDevice device, const std::span<const VkDescriptorPool> pools);
+
+            // VK_NULL_HANDLE when no pool is idle
+            VkDescriptorPool acquire();
+
+            void destroyPools(const VkDevice device);
+
+            RecyclerStatistics getStatistics() const;
+
+        private:
+            mutable std::mutex mutex;
+
+            std::vector<VkDescriptorPool> idle_pools;
+
+            std::size_t recycled_pools {};
+            std::size_t reused_pools {};
+    };
+}
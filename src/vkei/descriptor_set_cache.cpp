@@ -0,0 +1,76 @@
+#include "descriptor_set_cache.hpp"
+#include <utility>
+
+namespace mdsm::vkei
+{
+    std::size_t DescriptorSetCache::KeyHash::operator()(const Key& key) const
+    {
+        return static_cast<std::size_t>(key.hash);
+    }
+
+    VkDescriptorSet DescriptorSetCache::getDescriptorSet(
+        const VkDevice device,
+        const VkDescriptorSetLayout layout,
+        DescriptorWriter& writer,
+        DescriptorAllocator& descriptor_allocator
+    )
+    {
+        Key key {
+            .hash = 0xcbf29ce484222325,
+            .content = writer.getContentKey(layout)
+        };
+
+        // FNV-1a over whole words
+        for(const auto word : key.content)
+        {
+            key.hash = (key.hash ^ word) * 0x100000001b3;
+        }
+
+        {
+            std::lock_guard lock {mutex};
+
+            if(const auto entry {entries.find(key)}; entry != entries.end())
+            {
+                ++hits;
+
+                return entry->second;
+            }
+        }
+
+        // Allocated and written outside the lock, another thread may insert the same contents
+        // meanwhile, its set is kept and this one stays unused in the pool
+        const VkDescriptorSet descriptor_set {descriptor_allocator.allocate(device, layout)};
+
+        writer.updateDescriptorSet(device, descriptor_set);
+
+        std::lock_guard lock {mutex};
+
+        ++misses;
+
+        return entries.try_emplace(std::move(key), descriptor_set).first->second;
+    }
+
+    void DescriptorSetCache::clear()
+    {
+        std::lock_guard lock {mutex};
+
+        evictions += entries.size();
+
+        entries.clear();
+    }
+
+    DescriptorSetCache::CacheStatistics DescriptorSetCache::getStatistics() const
+    {
+        std::lock_guard lock {mutex};
+
+        const std::size_t lookups {hits + misses};
+
+        return CacheStatistics{
+            .hits = hits,
+            .misses = misses,
+            .evictions = evictions,
+            .entry_count = entries.size(),
+            .hit_rate = lookups? static_cast<double>(hits) / lookups : 0
+        };
+    }
+}
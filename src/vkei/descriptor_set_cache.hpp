@@ -0,0 +1,74 @@
+#pragma once
+
+#include "descriptor_allocator.hpp"
+#include "descriptor_writer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Shares one descriptor set between writers with identical contents. Entries hold raw
+    // handles, so the written resources must outlive them and the cache must be cleared
+    // whenever the pools backing its sets are reset
+    class DescriptorSetCache
+    {
+        public:
+            struct CacheStatistics
+            {
+                std::size_t hits;
+                std::size_t misses;
+
+                // Entries dropped by clear
+                std::size_t evictions;
+
+                std::size_t entry_count;
+
+                double hit_rate;
+            };
+
+            DescriptorSetCache() = default;
+
+            DescriptorSetCache(const DescriptorSetCache&) = delete;
+            DescriptorSetCache& operator=(const DescriptorSetCache&) = delete;
+
+            // Returns the set written with the writer's contents, allocating and updating one on a miss.
+            // Thread-safe as long as the allocator is only used by the calling thread
+            VkDescriptorSet getDescriptorSet(
+                const VkDevice device,
+                const VkDescriptorSetLayout layout,
+                DescriptorWriter& writer,
+                DescriptorAllocator& descriptor_allocator
+            );
+
+            void clear();
+
+            CacheStatistics getStatistics() const;
+
+        private:
+            struct Key
+            {
+                std::uint64_t hash;
+
+                std::vector<std::uint64_t> content;
+
+                bool operator==(const Key&) const = default;
+            };
+
+            struct KeyHash
+            {
+                std::size_t operator()(const Key& key) const;
+            };
+
+            mutable std::mutex mutex;
+
+            std::unordered_map<Key, VkDescriptorSet, KeyHash> entries;
+
+            std::size_t hits {};
+            std::size_t misses {};
+            std::size_t evictions {};
+    };
+}
@@ -1,6 +1,10 @@
 #include "descriptor_writer.hpp"
 
+#include <bit>
 #include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
 
 namespace mdsm::vkei
 {
@@ -40,7 +44,8 @@ namespace mdsm::vkei
         const VkImageView image,
         const VkSampler sampler,
         const VkImageLayout layout,
-        const VkDescriptorType type
+        const VkDescriptorType type,
+        const std::uint32_t array_element
     )
     {
         VkDescriptorImageInfo& info {
@@ -58,6 +63,7 @@ namespace mdsm::vkei
         };
     
         write.dstBinding = binding;
+        write.dstArrayElement = array_element;
         write.dstSet = VK_NULL_HANDLE;
         write.descriptorCount = 1;
         write.descriptorType = type;
@@ -66,6 +72,38 @@ namespace mdsm::vkei
         writes.push_back(write);
     }
     
+    std::vector<std::uint64_t> DescriptorWriter::getContentKey(const VkDescriptorSetLayout layout) const
+    {
+        std::vector<std::uint64_t> key;
+
+        key.reserve(1 + writes.size() * 4);
+
+        key.push_back(std::bit_cast<std::uint64_t>(layout));
+
+        for(const auto& write : writes)
+        {
+            key.push_back(
+                static_cast<std::uint64_t>(write.dstBinding) << 32 | write.dstArrayElement
+            );
+            key.push_back(static_cast<std::uint64_t>(write.descriptorType));
+
+            if(write.pBufferInfo)
+            {
+                key.push_back(std::bit_cast<std::uint64_t>(write.pBufferInfo->buffer));
+                key.push_back(write.pBufferInfo->offset);
+                key.push_back(write.pBufferInfo->range);
+            }
+            else
+            {
+                key.push_back(std::bit_cast<std::uint64_t>(write.pImageInfo->imageView));
+                key.push_back(std::bit_cast<std::uint64_t>(write.pImageInfo->sampler));
+                key.push_back(static_cast<std::uint64_t>(write.pImageInfo->imageLayout));
+            }
+        }
+
+        return key;
+    }
+
     void DescriptorWriter::clear()
     {
         image_infos.clear();
@@ -87,5 +125,118 @@ namespace mdsm::vkei
             0, 
             nullptr
         );
-    }    
+    }
+
+    void DescriptorWriter::pushDescriptorSet(
+        const VkCommandBuffer command_buffer,
+        const VkPipelineBindPoint bind_point,
+        const VkPipelineLayout layout,
+        const std::uint32_t set
+    ) const
+    {
+        // dstSet is ignored for pushed writes
+        vkCmdPushDescriptorSet(
+            command_buffer,
+            bind_point,
+            layout,
+            set,
+            static_cast<std::uint32_t>(writes.size()),
+            writes.data()
+        );
+    }
+
+    VkDeviceSize DescriptorWriter::writeDescriptorBuffer(
+        const VkDevice device,
+        const VkDescriptorSetLayout layout,
+        DescriptorBuffer& descriptor_buffer
+    )
+    {
+        const DescriptorBuffer::Allocation allocation {descriptor_buffer.allocate(layout)};
+
+        const DescriptorBufferFunctions& functions {descriptor_buffer.getFunctions()};
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties {descriptor_buffer.getProperties()};
+
+        for(const auto& write : writes)
+        {
+            VkDescriptorGetInfoEXT get_info {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+                .pNext = nullptr
+            };
+
+            get_info.type = write.descriptorType;
+
+            VkDescriptorAddressInfoEXT address_info {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+                .pNext = nullptr
+            };
+
+            if(write.pBufferInfo)
+            {
+                VkBufferDeviceAddressInfo device_address_info {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                    .pNext = nullptr
+                };
+
+                device_address_info.buffer = write.pBufferInfo->buffer;
+
+                address_info.address = vkGetBufferDeviceAddress(device, &device_address_info)
+                    + write.pBufferInfo->offset;
+                address_info.range = write.pBufferInfo->range;
+                address_info.format = VK_FORMAT_UNDEFINED;
+            }
+
+            std::size_t descriptor_size;
+
+            switch(write.descriptorType)
+            {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    get_info.data.pUniformBuffer = &address_info;
+                    descriptor_size = properties.uniformBufferDescriptorSize;
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    get_info.data.pStorageBuffer = &address_info;
+                    descriptor_size = properties.storageBufferDescriptorSize;
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    get_info.data.pCombinedImageSampler = write.pImageInfo;
+                    descriptor_size = properties.combinedImageSamplerDescriptorSize;
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    get_info.data.pSampledImage = write.pImageInfo;
+                    descriptor_size = properties.sampledImageDescriptorSize;
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    get_info.data.pStorageImage = write.pImageInfo;
+                    descriptor_size = properties.storageImageDescriptorSize;
+                    break;
+
+                default:
+                    throw std::runtime_error{
+                        std::format(
+                            "{} is not supported in descriptor buffers!",
+                            string_VkDescriptorType(write.descriptorType)
+                        )
+                    };
+            }
+
+            VkDeviceSize binding_offset;
+
+            functions.get_binding_offset(device, layout, write.dstBinding, &binding_offset);
+
+            functions.get_descriptor(
+                device,
+                &get_info,
+                descriptor_size,
+                allocation.data + binding_offset + write.dstArrayElement * descriptor_size
+            );
+        }
+
+        descriptor_buffer.flush(allocation);
+
+        return allocation.offset;
+    }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "descriptor_buffer.hpp"
+#include <cstdint>
 #include <deque>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -19,7 +21,8 @@ namespace mdsm::vkei
                 const VkImageView image,
                 const VkSampler sampler,
                 const VkImageLayout layout,
-                const VkDescriptorType type
+                const VkDescriptorType type,
+                const std::uint32_t array_element = 0
             );
 
             void writeBuffer(
@@ -34,6 +37,25 @@ namespace mdsm::vkei
                 const VkDevice device, const VkDescriptorSet set
             );
 
+            // Writes straight into the command buffer, the layout must be a push-descriptor layout
+            void pushDescriptorSet(
+                const VkCommandBuffer command_buffer,
+                const VkPipelineBindPoint bind_point,
+                const VkPipelineLayout layout,
+                const std::uint32_t set
+            ) const;
+
+            // Allocates room for the layout and writes the pending descriptors into it,
+            // returns the offset to bind. Buffer descriptors need device-addressable buffers
+            VkDeviceSize writeDescriptorBuffer(
+                const VkDevice device,
+                const VkDescriptorSetLayout layout,
+                DescriptorBuffer& descriptor_buffer
+            );
+
+            // The layout followed by every pending write, equal keys produce equal sets
+            std::vector<std::uint64_t> getContentKey(const VkDescriptorSetLayout layout) const;
+
             void clear();
 
         private:
@@ -6,7 +6,10 @@
 #include "types.hpp"
 #include <SDL3/SDL_init.h>
 #include <SDL3/SDL_vulkan.h>
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <glm/ext/matrix_clip_space.hpp>
@@ -17,7 +20,10 @@
 #include <glm/trigonometric.hpp>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
+#include <thread>
 #include <vk_video/vulkan_video_codec_av1std.h>
 #include <vulkan/vulkan_core.h>
 #define VMA_IMPLEMENTATION
@@ -41,13 +47,63 @@ namespace mdsm::vkei
         const std::size_t window_width,
         const std::size_t window_height,
         const std::string_view window_title,
-        const bool debug
+        const bool debug,
+        const EngineSettings& settings
     )
     :
         debug {debug},
+        settings {settings},
+        job_system {settings.worker_threads},
+        frame_overlap {settings.frames_in_flight},
+        recording_thread_count {
+            std::clamp<std::size_t>(
+                settings.recording_threads? 
+                    settings.recording_threads : job_system.getWorkerCount() + 1,
+                1,
+                max_recording_threads
+            )
+        },
+        frames (settings.frames_in_flight),
+        target_frame_time {settings.target_frame_time},
         metal_rough_material {}
     {
-        initializeWindow(window_width, window_height, window_title);
+        if(frame_overlap < min_frames_in_flight || frame_overlap > max_frames_in_flight)
+        {
+            throw std::runtime_error{
+                std::format(
+                    "Frames in flight must be between {} and {} (got {})!",
+                    min_frames_in_flight,
+                    max_frames_in_flight,
+                    frame_overlap
+                )
+            };
+        }
+
+        if(settings.bindless_materials && settings.descriptor_buffers)
+        {
+            throw std::runtime_error{"Bindless materials cannot be combined with descriptor buffers!"};
+        }
+
+        if(settings.push_scene_descriptors && settings.descriptor_buffers)
+        {
+            throw std::runtime_error{"Pushed scene descriptors cannot be combined with descriptor buffers!"};
+        }
+
+        if(settings.headless_readback && !settings.headless)
+        {
+            throw std::runtime_error{"Frame readback is only available in headless mode!"};
+        }
+
+        if(settings.headless)
+        {
+            window_extent.width = window_width;
+            window_extent.height = window_height;
+        }
+        else 
+        {
+            initializeWindow(window_width, window_height, window_title);
+        }
+
         initializeInstance(app_name);
         initializePhysicalDevice();
         initializeLogicalDevice();
@@ -56,8 +112,17 @@ namespace mdsm::vkei
         initializeQueues();
         initializeCommands();
         initializeSyncStructures();
+        initializeUploadService();
+        initializeGeometryPool();
+        initializeQueries();
+        initializeTransientArenas();
+        initializeReadbackBuffers();
         initializeDescriptors();
+        initializeDescriptorBuffers();
+        initializeBindlessTable();
         initializePipelines();
+        initializeGpuCulling();
+        initializeInstanceBuffers();
         initializeDefaultData();
     }
     
@@ -137,7 +202,7 @@ namespace mdsm::vkei
         AllocatedBuffer material_constants {
             createBuffer(
                 sizeof(MetallicRoughness::MaterialConstants), 
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
                 VMA_MEMORY_USAGE_CPU_TO_GPU
             )
         };
@@ -162,12 +227,14 @@ namespace mdsm::vkei
 
         material_resources.data_buffer = material_constants.buffer;
         material_resources.data_buffer_offset = 0;
+        material_resources.constants = scene_uniform_data;
 
         default_data = metal_rough_material.writeMaterial(
             logical_device, 
             MaterialPass::MainColor, 
             material_resources,
-            global_descriptor_allocator
+            global_descriptor_allocator,
+            &global_descriptor_cache
         );
 
         /*
@@ -214,7 +281,7 @@ namespace mdsm::vkei
         };        
 
         cube.mesh_buffers = uploadMesh(
-            cube_indices, cube_vertices
+            cube_indices, cube_vertices, cube.surfaces
         );
 
         const auto cube_asset {std::make_shared<MeshAsset>(cube)};
@@ -249,18 +316,43 @@ namespace mdsm::vkei
 
     void Engine::initializePipelines()
     {
+        if(settings.bindless_materials)
+        {
+            metal_rough_material.bindless_table = &bindless_table;
+
+            metal_rough_material.buildPipeline(
+                this,
+                "../shaders/mesh_bindless.vert.spv",
+                "../shaders/mesh_indirect_bindless.vert.spv",
+                "../shaders/mesh_bindless.frag.spv"
+            );
+
+            return;
+        }
+
+        if(settings.descriptor_buffers)
+        {
+            metal_rough_material.descriptor_buffer = &material_descriptor_buffer;
+        }
+
         metal_rough_material.buildPipeline(
             this,
             "../shaders/mesh.vert.spv",
+            "../shaders/mesh_indirect.vert.spv",
             "../shaders/mesh.frag.spv"
         );
     }
 
     void Engine::updateScene()
     {
-        main_draw_context.opaque_surfaces.clear();
+        // The GPU-driven path keeps its objects resident, an unchanged scene is not walked again
+        if(!settings.gpu_driven || gpu_scene_dirty)
+        {
+            main_draw_context.opaque_surfaces.clear();
+            main_draw_context.transparent_surfaces.clear();
 
-        //loaded_nodes["cube"]->draw(glm::mat4{1.f}, main_draw_context);
+            traverseScene(glm::mat4{1.f});
+        }
 
         scene_data.view = glm::translate(glm::mat4{1.0f}, glm::vec3{0, 0, -5});
         scene_data.proj = glm::perspective(
@@ -278,6 +370,58 @@ namespace mdsm::vkei
         scene_data.sunlight_direction = glm::vec4{0, 1, 0.5, 1.f};
     }
 
+    void Engine::traverseScene(const glm::mat4& top_matrix)
+    {
+        traversal_roots.clear();
+
+        for(const auto& [name, node] : loaded_nodes)
+        {
+            traversal_roots.push_back(node.get());
+        }
+
+        const std::size_t job_count {
+            (traversal_roots.size() + nodes_per_traversal_job - 1) / nodes_per_traversal_job
+        };
+
+        traversal_contexts.resize(std::max(job_count, traversal_contexts.size()));
+
+        job_system.parallelFor(
+            traversal_roots.size(),
+            nodes_per_traversal_job,
+            [&](const std::size_t begin, const std::size_t end)
+            {
+                DrawContext& context {traversal_contexts[begin / nodes_per_traversal_job]};
+
+                context.opaque_surfaces.clear();
+                context.transparent_surfaces.clear();
+                context.geometry_pool = &geometry_pool;
+
+                for(std::size_t root {begin}; root < end; ++root)
+                {
+                    traversal_roots[root]->draw(top_matrix, context);
+                }
+            }
+        );
+
+        // Merged in job order so the draw list does not depend on scheduling
+        for(std::size_t job {}; job < job_count; ++job)
+        {
+            const DrawContext& context {traversal_contexts[job]};
+
+            main_draw_context.opaque_surfaces.insert(
+                main_draw_context.opaque_surfaces.end(),
+                context.opaque_surfaces.begin(),
+                context.opaque_surfaces.end()
+            );
+
+            main_draw_context.transparent_surfaces.insert(
+                main_draw_context.transparent_surfaces.end(),
+                context.transparent_surfaces.begin(),
+                context.transparent_surfaces.end()
+            );
+        }
+    }
+
     void Engine::initializeWindow(
         const std::size_t width,
         const std::size_t height,
@@ -308,35 +452,38 @@ namespace mdsm::vkei
         };
     
         global_descriptor_allocator.initialize(logical_device, 10, sizes);
-    
+
         {
-            DescriptorLayoutBuilder builder;
-    
-            builder.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
-    
-            draw_image_descriptor_layout = builder.build(logical_device, VK_SHADER_STAGE_VERTEX_BIT);
+            std::vector<DescriptorAllocator::PoolSizeRatio> material_sizes {
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2}
+            };
+
+            for(std::size_t thread {}; thread <= job_system.getWorkerCount(); ++thread)
+            {
+                material_descriptor_allocators.push_back(std::make_unique<DescriptorAllocator>());
+
+                material_descriptor_allocators.back()->initialize(
+                    logical_device, material_sets_per_thread, material_sizes, &material_pool_recycler
+                );
+            }
         }
     
         {
             DescriptorLayoutBuilder builder;
     
             builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+            constexpr VkShaderStageFlags scene_stages {VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT};
     
-            scene_data_descriptor_layout = builder.build(
-                logical_device, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
-            );
-        }
-    
-        draw_image_descriptors = global_descriptor_allocator.allocate(logical_device, draw_image_descriptor_layout);
-    
-        {
-            DescriptorWriter writer;
-    
-            writer.writeImage(
-                0, draw_image.image_view, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
-            );
-    
-            writer.updateDescriptorSet(logical_device, draw_image_descriptors);
+            scene_data_descriptor_layout = settings.push_scene_descriptors
+                ? builder.buildPushDescriptorLayout(logical_device, scene_stages)
+                : builder.build(
+                    logical_device,
+                    scene_stages,
+                    nullptr,
+                    settings.descriptor_buffers? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0
+                );
         }
     
         resource_cleaner.addCleaner(
@@ -345,8 +492,14 @@ namespace mdsm::vkei
                 if(debug) std::println("Destroying desc allocator and desc layout");
 
                 global_descriptor_allocator.destroyPools(logical_device);
+
+                for(const auto& material_allocator : material_descriptor_allocators)
+                {
+                    material_allocator->destroyPools(logical_device);
+                }
+
+                material_pool_recycler.destroyPools(logical_device);
     
-                vkDestroyDescriptorSetLayout(logical_device, draw_image_descriptor_layout, nullptr);
                 vkDestroyDescriptorSetLayout(logical_device, scene_data_descriptor_layout, nullptr);
             }
         );
@@ -375,6 +528,101 @@ namespace mdsm::vkei
     
     
     
+    void Engine::initializeDescriptorBuffers()
+    {
+        if(!settings.descriptor_buffers)
+        {
+            return;
+        }
+
+        descriptor_buffer_functions = loadDescriptorBufferFunctions(logical_device);
+
+        descriptor_buffer_properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+            .pNext = nullptr
+        };
+
+        VkPhysicalDeviceProperties2 properties {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &descriptor_buffer_properties
+        };
+
+        vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+        // The material buffer holds combined image samplers and counts as both kinds
+        if(
+            descriptor_buffer_properties.maxDescriptorBufferBindings < 2
+            || descriptor_buffer_properties.maxResourceDescriptorBufferBindings < 2
+            || descriptor_buffer_properties.maxSamplerDescriptorBufferBindings < 1
+        )
+        {
+            throw std::runtime_error{"The device cannot bind enough descriptor buffers at once!"};
+        }
+
+        for(auto& frame : frames)
+        {
+            frame.descriptor_buffer.initialize(
+                logical_device,
+                allocator,
+                descriptor_buffer_functions,
+                descriptor_buffer_properties,
+                frame_descriptor_buffer_size,
+                VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT
+            );
+
+            resource_cleaner.addCleaner(
+                [&, this]
+                {
+                    if(debug) std::println("Destroying frame descriptor buffer");
+
+                    frame.descriptor_buffer.destroy();
+                }
+            );
+        }
+
+        material_descriptor_buffer.initialize(
+            logical_device,
+            allocator,
+            descriptor_buffer_functions,
+            descriptor_buffer_properties,
+            material_descriptor_buffer_size,
+            VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT
+        );
+
+        resource_cleaner.addCleaner(
+            [&, this]
+            {
+                if(debug) std::println("Destroying material descriptor buffer");
+
+                material_descriptor_buffer.destroy();
+            }
+        );
+    }
+
+    void Engine::initializeBindlessTable()
+    {
+        if(!settings.bindless_materials)
+        {
+            return;
+        }
+
+        bindless_table.initialize(
+            logical_device,
+            allocator,
+            bindless_texture_capacity,
+            bindless_material_capacity
+        );
+
+        resource_cleaner.addCleaner(
+            [&, this]
+            {
+                if(debug) std::println("Destroying bindless table");
+
+                bindless_table.destroy();
+            }
+        );
+    }
+
     void Engine::initializeInstance(const std::string_view app_name)
     {
         vkb::InstanceBuilder builder;
@@ -384,6 +632,7 @@ namespace mdsm::vkei
             .set_app_name(app_name.data())
             .request_validation_layers(debug)
             .require_api_version(1, 4, 0)
+            .set_headless(settings.headless)
             .build()
         };
     
@@ -400,6 +649,11 @@ namespace mdsm::vkei
     
         debug_messenger = vkb_instance.debug_messenger;    
     
+        if(settings.headless)
+        {
+            return;
+        }
+
         if(
             !SDL_Vulkan_CreateSurface(window, instance, nullptr, &surface)
         )
@@ -412,6 +666,12 @@ namespace mdsm::vkei
     {
         vkb::PhysicalDeviceSelector physical_device_selector {vkb_instance};
     
+        VkPhysicalDeviceVulkan14Features features_14 {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_4_FEATURES
+        };
+
+        features_14.pushDescriptor = settings.push_scene_descriptors;
+
         VkPhysicalDeviceVulkan13Features features_13 {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES
         };
@@ -425,14 +685,51 @@ namespace mdsm::vkei
     
         features_12.bufferDeviceAddress = true;
         features_12.descriptorIndexing = true;
+        features_12.timelineSemaphore = true;
+        features_12.drawIndirectCount = settings.gpu_driven;
+
+        if(settings.bindless_materials)
+        {
+            features_12.runtimeDescriptorArray = true;
+            features_12.descriptorBindingPartiallyBound = true;
+            features_12.descriptorBindingVariableDescriptorCount = true;
+            features_12.descriptorBindingSampledImageUpdateAfterBind = true;
+            features_12.descriptorBindingUpdateUnusedWhilePending = true;
+            features_12.shaderSampledImageArrayNonUniformIndexing = true;
+        }
+
+        VkPhysicalDeviceFeatures features {};
+
+        features.drawIndirectFirstInstance = settings.gpu_driven;
     
-        const auto physical_device_ret {
+        physical_device_selector
+        .set_required_features(features)
+        .set_required_features_14(features_14)
+        .set_required_features_13(features_13)
+        .set_required_features_12(features_12)
+        .set_minimum_version(1, 4);
+
+        if(settings.descriptor_buffers)
+        {
+            VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+                .pNext = nullptr
+            };
+
+            descriptor_buffer_features.descriptorBuffer = true;
+
             physical_device_selector
-            .set_required_features_13(features_13)
-            .set_required_features_12(features_12)
-            .set_minimum_version(1, 4)
-            .set_surface(surface)
-            .select()
+            .add_required_extension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)
+            .add_required_extension_features(descriptor_buffer_features);
+        }
+
+        if(!settings.headless)
+        {
+            physical_device_selector.set_surface(surface);
+        }
+    
+        const auto physical_device_ret {
+            physical_device_selector.select()
         };
     
         if(!physical_device_ret)
@@ -468,6 +765,29 @@ namespace mdsm::vkei
         graphics_queue = vkb_device.get_queue(vkb::QueueType::graphics).value();
     
         graphics_queue_family = vkb_device.get_queue_index(vkb::QueueType::graphics).value();
+
+        const auto dedicated_transfer_queue {
+            vkb_device.get_dedicated_queue(vkb::QueueType::transfer)
+        };
+
+        if(dedicated_transfer_queue)
+        {
+            transfer_queue = dedicated_transfer_queue.value();
+
+            transfer_queue_family = vkb_device.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+        }
+        else 
+        {
+            transfer_queue = graphics_queue;
+
+            transfer_queue_family = graphics_queue_family;
+        }
+
+        if(debug) std::println(
+            "Uploading through {} queue family {}", 
+            transfer_queue_family == graphics_queue_family? "graphics" : "dedicated transfer",
+            transfer_queue_family
+        );
     }
     
     void Engine::initializeAllocator()
@@ -499,7 +819,11 @@ namespace mdsm::vkei
         cleanup();
     }
     
-    void Engine::createSwapchain(const std::size_t width, const std::size_t height)
+    void Engine::createSwapchain(
+        const std::size_t width,
+        const std::size_t height,
+        const VkSwapchainKHR old_swapchain
+    )
     {
         vkb::SwapchainBuilder swapchain_builder {
             physical_device,
@@ -508,6 +832,8 @@ namespace mdsm::vkei
         };
     
         swapchain_image_format = VK_FORMAT_B8G8R8A8_UNORM;
+
+        present_mode = selectPresentMode(settings.present_mode);
     
         VkSurfaceFormatKHR surface_format;
     
@@ -517,8 +843,9 @@ namespace mdsm::vkei
         const auto vkb_swapchain_ret {
             swapchain_builder
             .set_desired_format(surface_format)
-            .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
+            .set_desired_present_mode(present_mode)
             .set_desired_extent(width, height)
+            .set_old_swapchain(old_swapchain)
             .add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
             .build()
         };
@@ -538,13 +865,86 @@ namespace mdsm::vkei
     
     
     
+    VkPresentModeKHR Engine::selectPresentMode(const PresentModePolicy policy) const
+    {
+        std::uint32_t mode_count {};
+
+        check(
+            vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &mode_count, nullptr)
+        );
+
+        std::vector<VkPresentModeKHR> supported_modes (mode_count);
+
+        check(
+            vkGetPhysicalDeviceSurfacePresentModesKHR(
+                physical_device, surface, &mode_count, supported_modes.data()
+            )
+        );
+
+        std::vector<VkPresentModeKHR> preferred_modes;
+
+        switch(policy)
+        {
+            case PresentModePolicy::Immediate:
+                preferred_modes = {
+                    VK_PRESENT_MODE_IMMEDIATE_KHR,
+                    VK_PRESENT_MODE_MAILBOX_KHR,
+                    VK_PRESENT_MODE_FIFO_RELAXED_KHR
+                };
+                break;
+
+            case PresentModePolicy::Mailbox:
+                preferred_modes = {
+                    VK_PRESENT_MODE_MAILBOX_KHR,
+                    VK_PRESENT_MODE_IMMEDIATE_KHR
+                };
+                break;
+
+            case PresentModePolicy::FifoRelaxed:
+                preferred_modes = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+                break;
+
+            case PresentModePolicy::Fifo:
+                break;
+        }
+
+        for(const auto mode : preferred_modes)
+        {
+            if(std::ranges::find(supported_modes, mode) != supported_modes.end())
+            {
+                return mode;
+            }
+        }
+
+        // FIFO is the only mode every surface is required to support
+        return VK_PRESENT_MODE_FIFO_KHR;
+    }
+
     void Engine::initializeSwapchain()
     {
-        createSwapchain(window_extent.width, window_extent.height);
+        if(!settings.headless)
+        {
+            createSwapchain(window_extent.width, window_extent.height);
+        }
+
+        createRenderTargets(window_extent);
     
+        resource_cleaner.addCleaner(
+            [this]
+            {
+                if(debug) std::println("Destroying images");
+
+                destroyImage(depth_image);
+                destroyImage(draw_image);
+            }
+        );
+    }
+
+    void Engine::createRenderTargets(const VkExtent2D extent)
+    {
         VkExtent3D draw_image_extent {
-            window_extent.width,
-            window_extent.height,
+            extent.width,
+            extent.height,
             1
         };
     
@@ -608,13 +1008,15 @@ namespace mdsm::vkei
             )
         };
     
-        vmaCreateImage(
-            allocator,
-            &depth_image_info,
-            &image_allocate_info,
-            &depth_image.image,
-            &depth_image.allocation,
-            nullptr
+        check(
+            vmaCreateImage(
+                allocator,
+                &depth_image_info,
+                &image_allocate_info,
+                &depth_image.image,
+                &depth_image.allocation,
+                nullptr
+            )
         );
     
         VkImageViewCreateInfo depth_image_view_info {
@@ -630,16 +1032,9 @@ namespace mdsm::vkei
                 logical_device, &depth_image_view_info, nullptr, &depth_image.image_view
             )
         );
-    
-        resource_cleaner.addCleaner(
-            [=, this]
-            {
-                if(debug) std::println("Destroying images");
 
-                destroyImage(depth_image);
-                destroyImage(draw_image);
-            }
-        );
+        image_states.track(draw_image);
+        image_states.track(depth_image);
     }
     
     void Engine::cleanup()
@@ -649,27 +1044,37 @@ namespace mdsm::vkei
         for(auto& frame : frames)
         {
             vkDestroyCommandPool(logical_device, frame.command_pool, nullptr);
+
+            for(const auto pool : frame.recording_pools)
+            {
+                vkDestroyCommandPool(logical_device, pool, nullptr);
+            }
     
-            vkDestroyFence(logical_device, frame.render_fence, nullptr);
             vkDestroySemaphore(logical_device, frame.render_semaphore, nullptr);
             vkDestroySemaphore(logical_device, frame.swapchain_semaphore, nullptr);
+
+            gpu_profiler.destroyQueryPool(logical_device, frame.timestamps);
         
             frame.resource_cleaner.flush();
         }
     
         for(auto& mesh : test_meshes)
         {
-            destroyBuffer(mesh->mesh_buffers.index_buffer);
-            destroyBuffer(mesh->mesh_buffers.vertex_buffer);
+            geometry_pool.free(mesh->mesh_buffers.geometry_handle);
         }
 
         metal_rough_material.clearResources(logical_device);
 
+        destroyRetiredResources(true);
+
         resource_cleaner.flush();
     
-        destroySwapchain();
+        if(!settings.headless)
+        {
+            destroySwapchain();
         
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        }
     
         vkDestroyDevice(logical_device, nullptr);
     
@@ -677,7 +1082,10 @@ namespace mdsm::vkei
         
         vkDestroyInstance(instance, nullptr);
     
-        SDL_DestroyWindow(window);
+        if(window)
+        {
+            SDL_DestroyWindow(window);
+        }
     }
     
     FrameData& Engine::getCurrentFrame()
@@ -718,17 +1126,64 @@ namespace mdsm::vkei
                     &frame.main_command_buffer
                 )
             );
-        }
-    
-        check(
-            vkCreateCommandPool(
-                logical_device,
-                &command_pool_info,
-                nullptr,
-                &immediate_command_pool
-            )
-        );
-    
+
+            VkCommandPoolCreateInfo recording_pool_info {
+                generateCommandPoolCreateInfo(graphics_queue_family)
+            };
+
+            frame.recording_pools.resize(recording_thread_count);
+            frame.recording_command_buffers.resize(recording_thread_count);
+
+            for(std::size_t thread {}; thread < recording_thread_count; ++thread)
+            {
+                check(
+                    vkCreateCommandPool(
+                        logical_device,
+                        &recording_pool_info,
+                        nullptr,
+                        &frame.recording_pools[thread]
+                    )
+                );
+
+                VkCommandBufferAllocateInfo secondary_allocate_info {
+                    generateCommandBufferAllocateInfo(
+                        frame.recording_pools[thread], 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                    )
+                };
+
+                check(
+                    vkAllocateCommandBuffers(
+                        logical_device,
+                        &secondary_allocate_info,
+                        &frame.recording_command_buffers[thread]
+                    )
+                );
+            }
+
+            VkCommandBufferAllocateInfo transparent_allocate_info {
+                generateCommandBufferAllocateInfo(
+                    frame.recording_pools[0], 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY
+                )
+            };
+
+            check(
+                vkAllocateCommandBuffers(
+                    logical_device,
+                    &transparent_allocate_info,
+                    &frame.transparent_command_buffer
+                )
+            );
+        }
+    
+        check(
+            vkCreateCommandPool(
+                logical_device,
+                &command_pool_info,
+                nullptr,
+                &immediate_command_pool
+            )
+        );
+    
         VkCommandBufferAllocateInfo command_buffer_allocate_info {
             generateCommandBufferAllocateInfo(
                 immediate_command_pool, 1
@@ -755,22 +1210,12 @@ namespace mdsm::vkei
     
     void Engine::initializeSyncStructures()
     {
-        VkFenceCreateInfo fence_create_info {
-            generateFenceCreateinfo(VK_FENCE_CREATE_SIGNALED_BIT)
-        };
-    
         VkSemaphoreCreateInfo semaphore_create_info {
             generateSemaphoreCreateInfo()
         };
     
         for(auto& frame : frames)
         {
-            check(
-                vkCreateFence(
-                    logical_device, &fence_create_info, nullptr, &frame.render_fence
-                )
-            );
-    
             check(
                 vkCreateSemaphore(
                     logical_device, &semaphore_create_info, nullptr, &frame.swapchain_semaphore
@@ -784,556 +1229,2152 @@ namespace mdsm::vkei
             );
         }
     
-        check(
-            vkCreateFence(
-                logical_device,
-                &fence_create_info,
-                nullptr,
-                &immediate_fence
-            )
-        );
+        graphics_timeline.initialize(logical_device);
     
         resource_cleaner.addCleaner(
             [this]
             {
-                if(debug) std::println("Destroying fence");
+                if(debug) std::println("Destroying timeline semaphore");
 
-                vkDestroyFence(logical_device, immediate_fence, nullptr);
+                graphics_timeline.destroy(logical_device);
             }
         );
     }
-    
-    void Engine::draw()
-    {
-        updateScene();
 
-        check(
-            vkWaitForFences(
-                logical_device, 1, &getCurrentFrame().render_fence, true, 1'000'000'000
-            )
+    void Engine::initializeUploadService()
+    {
+        upload_service.initialize(
+            logical_device,
+            allocator,
+            graphics_queue,
+            graphics_queue_family,
+            transfer_queue,
+            transfer_queue_family,
+            staging_ring_size,
+            job_system
         );
-    
-        getCurrentFrame().resource_cleaner.flush();
-        getCurrentFrame().frame_descriptors.clearPools(logical_device);
-    
-        std::uint32_t swapchain_image_index;
-    
-        if(
-            vkAcquireNextImageKHR(
-                logical_device,
-                swapchain,
-                1'000'000'000,
-                getCurrentFrame().swapchain_semaphore,
-                nullptr,
-                &swapchain_image_index
-            )
-            ==
-            VK_ERROR_OUT_OF_DATE_KHR
-        )
-        {
-            resize_requested = true;
-    
-            return;
-        }
 
-        draw_extent.width = std::min(swapchain_extent.width, draw_image.image_extent.width) * render_scale;
-        draw_extent.height = std::min(swapchain_extent.width, draw_image.image_extent.height) * render_scale;    
-        
-    
-        check(
-            vkResetFences(
-                logical_device, 1, &getCurrentFrame().render_fence
-            )
-        );
-    
-        VkCommandBuffer command_buffer {getCurrentFrame().main_command_buffer};
-    
-        check(vkResetCommandBuffer(command_buffer, 0));
-    
-        VkCommandBufferBeginInfo command_buffer_begin_info {
-            generateCommandBufferBeginInfo(
-                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
-            )
-        };
-    
-        check(vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info));
-    
-        changeImageLayout(
-            command_buffer,
-            draw_image.image,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_GENERAL
-        );
-    
-        //drawBackground(command_buffer);
-    
-        changeImageLayout(
-            command_buffer,
-            draw_image.image,
-            VK_IMAGE_LAYOUT_GENERAL, 
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-        );
-    
-        changeImageLayout(
-            command_buffer, 
-            depth_image.image, 
-            VK_IMAGE_LAYOUT_UNDEFINED, 
-            VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
-        );
-    
-        drawGeometry(command_buffer);
-    
-        changeImageLayout(
-            command_buffer,
-            draw_image.image,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-        );
-    
-        changeImageLayout(
-            command_buffer,
-            swapchain_images[swapchain_image_index],
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+        resource_cleaner.addCleaner(
+            [this]
+            {
+                if(debug) std::println("Destroying upload service");
+
+                upload_service.destroy();
+            }
         );
-    
-        copyImage(
-            command_buffer,
-            draw_image.image,
-            swapchain_images[swapchain_image_index],
-            draw_extent,
-            swapchain_extent
+    }
+
+    void Engine::initializeGeometryPool()
+    {
+        geometry_pool.initialize(
+            logical_device,
+            allocator,
+            upload_service,
+            geometry_pool_vertex_capacity,
+            geometry_pool_index_capacity
         );
-    
-        changeImageLayout(
-            command_buffer,
-            swapchain_images[swapchain_image_index],
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-        );    
-    
-        check(
-            vkEndCommandBuffer(command_buffer)
+
+        resource_cleaner.addCleaner(
+            [&, this]
+            {
+                if(debug) std::println("Destroying geometry pool");
+
+                geometry_pool.destroy();
+            }
         );
-    
-        VkCommandBufferSubmitInfo command_buffer_info {
-            generateCommandBufferSubmitInfo(command_buffer)
-        };
-    
-        VkSemaphoreSubmitInfo wait_info {
-            generateSemaphoreSubmitInfo(
-                VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-                getCurrentFrame().swapchain_semaphore
-            )
+    }
+
+    const RenderGraph::GraphStatistics& Engine::getRenderGraphStatistics() const
+    {
+        return render_graph.getStatistics();
+    }
+
+    const Engine::DrawStatistics& Engine::getDrawStatistics() const
+    {
+        return draw_statistics;
+    }
+
+    FrustumCuller::CullStatistics Engine::getCullStatistics() const
+    {
+        const FrustumCuller::CullStatistics& opaque {frustum_culler.getStatistics()};
+        const FrustumCuller::CullStatistics& transparent {transparent_culler.getStatistics()};
+
+        return FrustumCuller::CullStatistics{
+            .visible_count = opaque.visible_count + transparent.visible_count,
+            .culled_count = opaque.culled_count + transparent.culled_count,
+            .cull_time = opaque.cull_time + transparent.cull_time
         };
-    
-        VkSemaphoreSubmitInfo signal_info {
-            generateSemaphoreSubmitInfo(
-                VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
-                getCurrentFrame().render_semaphore
+    }
+
+    GeometryPool::PoolStatistics Engine::getGeometryStatistics() const
+    {
+        return geometry_pool.getStatistics();
+    }
+
+    void Engine::markSceneDirty()
+    {
+        gpu_scene_dirty = true;
+    }
+
+    GpuScene::SceneStatistics Engine::getGpuSceneStatistics() const
+    {
+        return gpu_scene.getStatistics();
+    }
+
+    std::shared_ptr<MeshAsset> Engine::createMesh(
+        std::string name,
+        const std::span<std::uint32_t> indices,
+        const std::span<Vertex> vertices,
+        std::vector<Surface> surfaces
+    )
+    {
+        auto mesh {std::make_shared<MeshAsset>()};
+
+        mesh->name = std::move(name);
+        mesh->surfaces = std::move(surfaces);
+        mesh->mesh_buffers = uploadMesh(indices, vertices, mesh->surfaces);
+
+        return mesh;
+    }
+
+    const MaterialInstance& Engine::getDefaultMaterial() const
+    {
+        return default_data;
+    }
+
+    std::vector<MetallicRoughness::MaterialResources> Engine::createMaterialResources(
+        const std::span<const MetallicRoughness::MaterialConstants> constants
+    )
+    {
+        // Every entry is 256 bytes, so each offset meets any uniform buffer alignment
+        static_assert(sizeof(MetallicRoughness::MaterialConstants) == 256);
+
+        const AllocatedBuffer constants_buffer {
+            createBuffer(
+                constants.size_bytes(),
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU
             )
         };
-    
-        VkSubmitInfo2 submit_info {
-            generateSubmitInfo(
-                &command_buffer_info,
-                &signal_info,
-                &wait_info
+
+        auto* const mapped_constants {
+            reinterpret_cast<MetallicRoughness::MaterialConstants*>(
+                constants_buffer.allocation_info.pMappedData
             )
         };
-    
+
+        std::ranges::copy(constants, mapped_constants);
+
         check(
-            vkQueueSubmit2(
-                graphics_queue,
-                1,
-                &submit_info,
-                getCurrentFrame().render_fence
-            )
+            vmaFlushAllocation(allocator, constants_buffer.allocation, 0, constants.size_bytes())
         );
-    
-        VkPresentInfoKHR present_info {
-            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-            .pNext = nullptr
-        };
-    
-        present_info.pSwapchains = &swapchain;
-        present_info.swapchainCount = 1;
-    
-        present_info.pWaitSemaphores = &getCurrentFrame().render_semaphore;
-        present_info.waitSemaphoreCount = 1;
-    
-        present_info.pImageIndices = &swapchain_image_index;
-    
-        if(
-            vkQueuePresentKHR(graphics_queue, &present_info)
-            ==
-            VK_ERROR_OUT_OF_DATE_KHR
-        )
+
+        resource_cleaner.addCleaner(
+            [=, this]
+            {
+                if(debug) std::println("Destroying material constants buffer");
+
+                destroyBuffer(constants_buffer);
+            }
+        );
+
+        std::vector<MetallicRoughness::MaterialResources> resources (constants.size());
+
+        for(std::size_t entry {}; entry < constants.size(); ++entry)
         {
-            resize_requested = true;
+            resources[entry].color_image = default_texture;
+            resources[entry].color_sampler = default_linear_sampler;
+            resources[entry].metal_roughness_image = default_texture;
+            resources[entry].metal_roughness_sampler = default_linear_sampler;
+            resources[entry].data_buffer = constants_buffer.buffer;
+            resources[entry].data_buffer_offset = static_cast<std::uint32_t>(
+                entry * sizeof(MetallicRoughness::MaterialConstants)
+            );
+            resources[entry].constants = &mapped_constants[entry];
         }
-    
-        ++frame_number;
+
+        return resources;
     }
-    
-    bool Engine::resizeRequested()
+
+    void Engine::addNode(std::string name, std::shared_ptr<Node> node)
     {
-        return resize_requested;
+        loaded_nodes[std::move(name)] = std::move(node);
+
+        markSceneDirty();
     }
-    
-    void Engine::destroySwapchain()
+
+    BindlessTable::TableStatistics Engine::getBindlessStatistics() const
     {
-        for(auto& image_view : swapchain_image_views)
-        {
-            vkDestroyImageView(
-                logical_device,
-                image_view,
-                nullptr
-            );
-        }
-    
-        vkDestroySwapchainKHR(
-            logical_device, swapchain, nullptr
-        );    
+        return bindless_table.getStatistics();
     }
-    
-    void Engine::resizeSwapchain()
+
+    const RollingStatistics& Engine::getDescriptorWriteStatistics() const
     {
-        vkDeviceWaitIdle(logical_device);
-    
-        destroySwapchain();
-    
-        int width;
-        int height;
-    
-        SDL_GetWindowSize(window, &width, &height);
-    
-        window_extent.width = width;
-        window_extent.height = height;
-    
-        createSwapchain(window_extent.width, window_extent.height);
-    
+        return descriptor_write_statistics;
+    }
+
+    const RollingStatistics& Engine::getRecordStatistics() const
+    {
+        return record_statistics;
+    }
+
+    std::vector<MaterialInstance> Engine::writeMaterials(
+        const std::span<const MetallicRoughness::MaterialRequest> requests
+    )
+    {
+        const auto write_start {std::chrono::steady_clock::now()};
+
+        std::vector<MaterialInstance> materials (requests.size());
+
+        constexpr std::size_t materials_per_job {64};
+
+        job_system.parallelFor(
+            requests.size(),
+            materials_per_job,
+            [&, this](const std::size_t begin, const std::size_t end)
+            {
+                DescriptorAllocator& thread_allocator {
+                    *material_descriptor_allocators[job_system.getQueueIndex()]
+                };
+
+                DescriptorWriter writer;
+
+                for(std::size_t request {begin}; request < end; ++request)
+                {
+                    materials[request] = metal_rough_material.writeMaterial(
+                        logical_device,
+                        requests[request].pass,
+                        requests[request].resources,
+                        thread_allocator,
+                        writer,
+                        &material_descriptor_cache
+                    );
+                }
+            }
+        );
+
+        const double milliseconds {
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - write_start
+            ).count()
+        };
+
+        material_write_statistics = MaterialWriteStatistics{
+            .material_count = requests.size(),
+            .thread_count = std::min(
+                job_system.getWorkerCount() + 1,
+                (requests.size() + materials_per_job - 1) / materials_per_job
+            ),
+            .milliseconds = milliseconds,
+            .materials_per_second = milliseconds > 0? requests.size() * 1000.0 / milliseconds : 0
+        };
+
+        return materials;
+    }
+
+    void Engine::releaseMaterialDescriptors()
+    {
+        material_descriptor_cache.clear();
+
+        for(const auto& material_allocator : material_descriptor_allocators)
+        {
+            material_allocator->releasePools(logical_device);
+        }
+    }
+
+    const Engine::MaterialWriteStatistics& Engine::getMaterialWriteStatistics() const
+    {
+        return material_write_statistics;
+    }
+
+    DescriptorPoolRecycler::RecyclerStatistics Engine::getMaterialPoolStatistics() const
+    {
+        return material_pool_recycler.getStatistics();
+    }
+
+    Engine::DescriptorCacheStatistics Engine::getDescriptorCacheStatistics() const
+    {
+        const std::size_t frame_index {frame_number == 0? 0 : (frame_number - 1) % frame_overlap};
+
+        return DescriptorCacheStatistics{
+            .frame = frames[frame_index].descriptor_cache.getStatistics(),
+            .global = global_descriptor_cache.getStatistics(),
+            .material = material_descriptor_cache.getStatistics()
+        };
+    }
+
+    DescriptorAllocator::AllocatorStatistics Engine::getFrameDescriptorStatistics() const
+    {
+        const std::size_t frame_index {frame_number == 0? 0 : (frame_number - 1) % frame_overlap};
+
+        return frames[frame_index].frame_descriptors.getStatistics();
+    }
+
+    void Engine::defragmentGeometry()
+    {
+        const GeometryPool::PoolStatistics statistics {geometry_pool.getStatistics()};
+
+        relocateGeometry(
+            static_cast<std::uint32_t>(statistics.vertex_capacity),
+            static_cast<std::uint32_t>(statistics.index_capacity)
+        );
+    }
+
+    const UploadService::UploadStatistics& Engine::getUploadStatistics() const
+    {
+        return upload_service.getStatistics();
+    }
+
+    std::uint64_t Engine::getLastSubmission() const
+    {
+        return graphics_timeline.getLastReservedValue();
+    }
+
+    bool Engine::isSubmissionComplete(const std::uint64_t submission) const
+    {
+        return graphics_timeline.isComplete(logical_device, submission);
+    }
+
+    bool Engine::waitForSubmission(const std::uint64_t submission, const std::uint64_t timeout) const
+    {
+        return graphics_timeline.wait(logical_device, submission, timeout);
+    }
+
+    void Engine::initializeQueries()
+    {
+        gpu_profiler.initialize(physical_device, graphics_queue_family);
+
+        for(auto& frame : frames)
+        {
+            gpu_profiler.createQueryPool(logical_device, frame.timestamps);
+        }
+    }
+
+    std::unordered_map<std::string_view, GpuProfiler::PassStatistics> Engine::getGpuPassStatistics() const
+    {
+        return gpu_profiler.getStatistics();
+    }
+
+    const RollingStatistics& Engine::getFrameWaitStatistics() const
+    {
+        return frame_wait_statistics;
+    }
+
+    std::size_t Engine::getFramesInFlight() const
+    {
+        return frame_overlap;
+    }
+
+    VkPresentModeKHR Engine::getPresentMode() const
+    {
+        return present_mode;
+    }
+
+    void Engine::setTargetFrameTime(const std::chrono::microseconds frame_time)
+    {
+        target_frame_time = frame_time;
+    }
+
+    const RollingStatistics& Engine::getPresentLatencyStatistics() const
+    {
+        return present_latency_statistics;
+    }
+
+    const RollingStatistics& Engine::getCpuFrameStatistics() const
+    {
+        return cpu_frame_statistics;
+    }
+
+    void Engine::initializeTransientArenas()
+    {
+        const VkPhysicalDeviceLimits& limits {vkb_physical_device.properties.limits};
+
+        const VkDeviceSize min_alignment {
+            std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment)
+        };
+
+        for(auto& frame : frames)
+        {
+            frame.transient_buffer = createBuffer(
+                transient_arena_size,
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+                | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU
+            );
+
+            frame.transient_arena.initialize(
+                frame.transient_buffer.buffer,
+                frame.transient_buffer.allocation_info.pMappedData,
+                transient_arena_size,
+                min_alignment
+            );
+
+            resource_cleaner.addCleaner(
+                [&, this]
+                {
+                    if(debug) std::println("Destroying transient buffer");
+
+                    destroyBuffer(frame.transient_buffer);
+                }
+            );
+        }
+    }
+
+    void Engine::initializeReadbackBuffers()
+    {
+        if(!settings.headless || !settings.headless_readback)
+        {
+            return;
+        }
+
+        const std::size_t readback_size {
+            window_extent.width * window_extent.height * readback_pixel_size
+        };
+
+        for(auto& frame : frames)
+        {
+            frame.readback_buffer = createBuffer(
+                readback_size,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VMA_MEMORY_USAGE_GPU_TO_CPU
+            );
+
+            resource_cleaner.addCleaner(
+                [&, this]
+                {
+                    if(debug) std::println("Destroying readback buffer");
+
+                    destroyBuffer(frame.readback_buffer);
+                }
+            );
+        }
+    }
+
+    void Engine::initializeGpuCulling()
+    {
+        if(!settings.gpu_driven)
+        {
+            return;
+        }
+
+        gpu_culler.initialize(logical_device, "../shaders/cull.comp.spv");
+
+        gpu_scene.initialize(logical_device, allocator, frame_overlap, min_gpu_object_capacity);
+
+        for(auto& frame : frames)
+        {
+            reserveGpuScene(frame, gpu_scene.getCommandCapacity(), min_gpu_batch_capacity);
+        }
+
+        resource_cleaner.addCleaner(
+            [&, this]
+            {
+                if(debug) std::println("Destroying GPU culling resources");
+
+                for(auto& frame : frames)
+                {
+                    destroyBuffer(frame.draw_command_buffer);
+                    destroyBuffer(frame.draw_count_buffer);
+                }
+
+                gpu_scene.destroy();
+                gpu_culler.destroy(logical_device);
+            }
+        );
+    }
+
+    void Engine::initializeInstanceBuffers()
+    {
+        for(auto& frame : frames)
+        {
+            reserveInstanceBuffer(frame, min_instance_capacity);
+
+            resource_cleaner.addCleaner(
+                [&, this]
+                {
+                    if(debug) std::println("Destroying instance buffer");
+
+                    destroyBuffer(frame.instance_buffer);
+                }
+            );
+        }
+    }
+
+    std::vector<std::byte> Engine::readFrame()
+    {
+        if(!settings.headless || !settings.headless_readback || frame_number == 0)
+        {
+            throw std::runtime_error{"No rendered frame is available for readback!"};
+        }
+
+        const FrameData& frame {frames[(frame_number - 1) % frame_overlap]};
+
+        if(!graphics_timeline.wait(logical_device, frame.timeline_value, 1'000'000'000))
+        {
+            throw VulkanException{VK_TIMEOUT};
+        }
+
+        check(
+            vmaInvalidateAllocation(allocator, frame.readback_buffer.allocation, 0, VK_WHOLE_SIZE)
+        );
+
+        std::vector<std::byte> pixels (
+            draw_extent.width * draw_extent.height * readback_pixel_size
+        );
+
+        std::memcpy(
+            pixels.data(), frame.readback_buffer.allocation_info.pMappedData, pixels.size()
+        );
+
+        return pixels;
+    }
+    
+    void Engine::waitForFrame(const FrameData& frame)
+    {
+        const auto wait_start {std::chrono::steady_clock::now()};
+
+        if(!graphics_timeline.wait(logical_device, frame.timeline_value, 1'000'000'000))
+        {
+            throw VulkanException{VK_TIMEOUT};
+        }
+
+        frame_wait_statistics.addSample(
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - wait_start
+            ).count()
+        );
+    }
+
+    void Engine::waitForNextFrame()
+    {
+        if(!frame_ready)
+        {
+            waitForFrame(getCurrentFrame());
+
+            frame_ready = true;
+        }
+
+        if(target_frame_time.count() > 0 && cpu_frame_statistics.getSampleCount() > 0)
+        {
+            // Start as late as possible while still presenting one target interval after the last frame
+            const auto predicted_work {
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::milli>(cpu_frame_statistics.getAverage())
+                )
+            };
+
+            std::this_thread::sleep_until(last_present_time + target_frame_time - predicted_work);
+        }
+    }
+
+    void Engine::draw()
+    {
+        const auto draw_start {std::chrono::steady_clock::now()};
+
+        updateScene();
+
+        if(!frame_ready)
+        {
+            waitForFrame(getCurrentFrame());
+        }
+
+        frame_ready = false;
+
+        upload_service.collect();
+    
+        gpu_profiler.collect(logical_device, getCurrentFrame().timestamps);
+
+        getCurrentFrame().resource_cleaner.flush();
+        // Cached sets outlive the frame, so the pools are only reset once in a while
+        if(++getCurrentFrame().descriptor_cache_frames == frame_descriptor_cache_lifetime)
+        {
+            getCurrentFrame().frame_descriptors.clearPools(logical_device);
+            getCurrentFrame().descriptor_cache.clear();
+            getCurrentFrame().descriptor_cache_frames = 0;
+        }
+
+        if(settings.descriptor_buffers)
+        {
+            getCurrentFrame().descriptor_buffer.reset();
+        }
+
+        destroyRetiredResources();
+
+        getCurrentFrame().transient_arena.reset();
+
+        for(const auto pool : getCurrentFrame().recording_pools)
+        {
+            check(
+                vkResetCommandPool(logical_device, pool, 0)
+            );
+        }
+    
+        std::uint32_t swapchain_image_index {};
+
+        std::chrono::steady_clock::time_point acquire_time;
+    
+        if(settings.headless)
+        {
+            draw_extent.width = draw_image.image_extent.width * render_scale;
+            draw_extent.height = draw_image.image_extent.height * render_scale;
+        }
+        else 
+        {
+            if(
+                vkAcquireNextImageKHR(
+                    logical_device,
+                    swapchain,
+                    1'000'000'000,
+                    getCurrentFrame().swapchain_semaphore,
+                    nullptr,
+                    &swapchain_image_index
+                )
+                ==
+                VK_ERROR_OUT_OF_DATE_KHR
+            )
+            {
+                resize_requested = true;
+        
+                return;
+            }
+
+            acquire_time = std::chrono::steady_clock::now();
+
+            draw_extent.width = std::min(swapchain_extent.width, draw_image.image_extent.width) * render_scale;
+            draw_extent.height = std::min(swapchain_extent.height, draw_image.image_extent.height) * render_scale;    
+        }
+        
+    
+        VkCommandBuffer command_buffer {getCurrentFrame().main_command_buffer};
+    
+        check(vkResetCommandBuffer(command_buffer, 0));
+    
+        VkCommandBufferBeginInfo command_buffer_begin_info {
+            generateCommandBufferBeginInfo(
+                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+            )
+        };
+    
+        check(vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info));
+
+        gpu_profiler.reset(command_buffer, getCurrentFrame().timestamps);
+
+        render_graph.reset();
+
+        const RenderGraph::ResourceHandle draw_target {
+            render_graph.importImage(
+                draw_image.image,
+                image_states.getAspectMask(draw_image.image),
+                image_states.getState(draw_image.image)
+            )
+        };
+
+        const RenderGraph::ResourceHandle depth_target {
+            render_graph.importImage(
+                depth_image.image,
+                image_states.getAspectMask(depth_image.image),
+                image_states.getState(depth_image.image)
+            )
+        };
+
+        render_graph.addPass(
+            "background",
+            {
+                {draw_target, ResourceUsage::TransferDestination}
+            },
+            [this](const VkCommandBuffer command_buffer)
+            {
+                drawBackground(command_buffer);
+            }
+        );
+
+        addGeometryPasses(draw_target, depth_target);
+    
+        if(settings.headless)
+        {
+            if(settings.headless_readback)
+            {
+                const RenderGraph::ResourceHandle readback_target {
+                    render_graph.importBuffer(getCurrentFrame().readback_buffer.buffer)
+                };
+
+                render_graph.addPass(
+                    "readback",
+                    {
+                        {draw_target, ResourceUsage::TransferSource},
+                        {readback_target, ResourceUsage::TransferDestination}
+                    },
+                    [this](const VkCommandBuffer command_buffer)
+                    {
+                        gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "readback");
+
+                        copyImageToBuffer(
+                            command_buffer,
+                            draw_image.image,
+                            getCurrentFrame().readback_buffer.buffer,
+                            draw_extent
+                        );
+
+                        gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+                    }
+                );
+
+                render_graph.setOutput(readback_target, ResourceUsage::HostRead);
+            }
+            else 
+            {
+                render_graph.setOutput(draw_target, ResourceUsage::TransferSource);
+            }
+
+            render_graph.execute(command_buffer);
+
+            check(
+                vkEndCommandBuffer(command_buffer)
+            );
+
+            submitHeadless(command_buffer);
+
+            last_present_time = std::chrono::steady_clock::now();
+
+            cpu_frame_statistics.addSample(
+                std::chrono::duration<double, std::milli>(last_present_time - draw_start).count()
+            );
+
+            ++frame_number;
+
+            return;
+        }
+
+        // The acquire semaphore is only waited on by the blit, the first swapchain barrier chains on it.
+        // Clears and copies cover the whole transfer stage, so the background and geometry passes
+        // run before the image is acquired
+        const RenderGraph::ResourceHandle swapchain_target {
+            render_graph.importImage(
+                swapchain_images[swapchain_image_index],
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_PIPELINE_STAGE_2_BLIT_BIT
+            )
+        };
+
+        render_graph.addPass(
+            "blit",
+            {
+                {draw_target, ResourceUsage::TransferSource},
+                {swapchain_target, ResourceUsage::TransferDestination}
+            },
+            [this, swapchain_image_index](const VkCommandBuffer command_buffer)
+            {
+                gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "blit");
+
+                copyImage(
+                    command_buffer,
+                    draw_image.image,
+                    swapchain_images[swapchain_image_index],
+                    draw_extent,
+                    swapchain_extent
+                );
+
+                gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+            }
+        );
+
+        render_graph.setOutput(swapchain_target, ResourceUsage::Present);
+
+        render_graph.execute(command_buffer);
+    
+        check(
+            vkEndCommandBuffer(command_buffer)
+        );
+    
+        VkCommandBufferSubmitInfo command_buffer_info {
+            generateCommandBufferSubmitInfo(command_buffer)
+        };
+    
+        VkSemaphoreSubmitInfo wait_info {
+            generateSemaphoreSubmitInfo(
+                VK_PIPELINE_STAGE_2_BLIT_BIT,
+                getCurrentFrame().swapchain_semaphore
+            )
+        };
+    
+        getCurrentFrame().timeline_value = graphics_timeline.reserveValue();
+
+        // Signalled at the stages the graph's final transition to present chains into
+        const std::array<VkSemaphoreSubmitInfo, 2> signal_infos {
+            generateSemaphoreSubmitInfo(
+                getResourceUsageInfo(ResourceUsage::Present).stage_mask,
+                getCurrentFrame().render_semaphore
+            ),
+            graphics_timeline.generateSignalInfo(getCurrentFrame().timeline_value)
+        };
+    
+        VkSubmitInfo2 submit_info {
+            generateSubmitInfo(
+                &command_buffer_info,
+                signal_infos,
+                std::span{&wait_info, 1}
+            )
+        };
+    
+        check(
+            vkQueueSubmit2(
+                graphics_queue,
+                1,
+                &submit_info,
+                VK_NULL_HANDLE
+            )
+        );
+    
+        VkPresentInfoKHR present_info {
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .pNext = nullptr
+        };
+    
+        present_info.pSwapchains = &swapchain;
+        present_info.swapchainCount = 1;
+    
+        present_info.pWaitSemaphores = &getCurrentFrame().render_semaphore;
+        present_info.waitSemaphoreCount = 1;
+    
+        present_info.pImageIndices = &swapchain_image_index;
+    
+        if(
+            vkQueuePresentKHR(graphics_queue, &present_info)
+            ==
+            VK_ERROR_OUT_OF_DATE_KHR
+        )
+        {
+            resize_requested = true;
+        }
+
+        last_present_time = std::chrono::steady_clock::now();
+
+        present_latency_statistics.addSample(
+            std::chrono::duration<double, std::milli>(last_present_time - acquire_time).count()
+        );
+
+        cpu_frame_statistics.addSample(
+            std::chrono::duration<double, std::milli>(last_present_time - draw_start).count()
+        );
+    
+        ++frame_number;
+    }
+
+    void Engine::submitHeadless(const VkCommandBuffer command_buffer)
+    {
+        VkCommandBufferSubmitInfo command_buffer_info {
+            generateCommandBufferSubmitInfo(command_buffer)
+        };
+
+        getCurrentFrame().timeline_value = graphics_timeline.reserveValue();
+
+        const VkSemaphoreSubmitInfo signal_info {
+            graphics_timeline.generateSignalInfo(getCurrentFrame().timeline_value)
+        };
+
+        VkSubmitInfo2 submit_info {
+            generateSubmitInfo(&command_buffer_info, &signal_info, nullptr)
+        };
+
+        check(
+            vkQueueSubmit2(
+                graphics_queue,
+                1,
+                &submit_info,
+                VK_NULL_HANDLE
+            )
+        );
+    }
+    
+    bool Engine::resizeRequested()
+    {
+        return resize_requested;
+    }
+    
+    void Engine::destroySwapchain()
+    {
+        for(auto& image_view : swapchain_image_views)
+        {
+            vkDestroyImageView(
+                logical_device,
+                image_view,
+                nullptr
+            );
+        }
+    
+        vkDestroySwapchainKHR(
+            logical_device, swapchain, nullptr
+        );    
+    }
+    
+    void Engine::resizeSwapchain()
+    {
+        if(settings.headless)
+        {
+            resize_requested = false;
+
+            return;
+        }
+    
+        int width;
+        int height;
+    
+        SDL_GetWindowSize(window, &width, &height);
+
+        if(width <= 0 || height <= 0)
+        {
+            return;
+        }
+    
+        window_extent.width = width;
+        window_extent.height = height;
+
+        {
+            const VkSwapchainKHR old_swapchain {swapchain};
+            const std::vector<VkImageView> old_image_views {swapchain_image_views};
+
+            createSwapchain(window_extent.width, window_extent.height, old_swapchain);
+
+            retireResource(
+                [=, this]
+                {
+                    if(debug) std::println("Destroying retired swapchain");
+
+                    for(const auto image_view : old_image_views)
+                    {
+                        vkDestroyImageView(logical_device, image_view, nullptr);
+                    }
+
+                    vkDestroySwapchainKHR(logical_device, old_swapchain, nullptr);
+                }
+            );
+        }
+
+        if(
+            draw_image.image_extent.width != window_extent.width
+            ||
+            draw_image.image_extent.height != window_extent.height
+        )
+        {
+            const AllocatedImage old_draw_image {draw_image};
+            const AllocatedImage old_depth_image {depth_image};
+
+            createRenderTargets(window_extent);
+
+            retireResource(
+                [=, this]
+                {
+                    if(debug) std::println("Destroying retired render targets");
+
+                    destroyImage(old_depth_image);
+                    destroyImage(old_draw_image);
+                }
+            );
+        }
+    
         resize_requested = false;
     }
-    
-    void Engine::drawBackground(const VkCommandBuffer command_buffer)
+
+    void Engine::retireResource(std::function<void()>&& cleaner)
+    {
+        retired_resources.push_back(
+            RetiredResource{
+                .retire_frame = frame_number,
+                .cleaner = std::move(cleaner)
+            }
+        );
+    }
+
+    void Engine::destroyRetiredResources(const bool force)
+    {
+        // Frames submitted before retirement are complete once every frame slot has cycled
+        while(
+            !retired_resources.empty()
+            &&
+            (force || frame_number >= retired_resources.front().retire_frame + frame_overlap)
+        )
+        {
+            retired_resources.front().cleaner();
+            retired_resources.pop_front();
+        }
+    }
+    
+    void Engine::drawBackground(const VkCommandBuffer command_buffer)
+    {
+        VkClearColorValue clear_value;
+    
+        clear_value = {
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        };
+    
+        VkImageSubresourceRange clear_range {
+            generateImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT)
+        };
+
+        gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "background");
+    
+        vkCmdClearColorImage(
+            command_buffer,
+            draw_image.image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            &clear_value,
+            1,
+            &clear_range
+        );
+
+        gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+    }
+    
+    void PipelineBuilder::enableDepthTest(
+        const bool depth_write_enable, const VkCompareOp op
+    )
+    {
+        depth_stencil.depthTestEnable = VK_TRUE;
+        depth_stencil.depthWriteEnable = depth_write_enable;
+        depth_stencil.depthCompareOp = op;
+        depth_stencil.depthBoundsTestEnable = VK_FALSE;
+        depth_stencil.stencilTestEnable = VK_FALSE;
+        depth_stencil.front = {};
+        depth_stencil.back = {};
+        depth_stencil.minDepthBounds = 0.f;
+        depth_stencil.maxDepthBounds = 1.f;
+    }
+    
+    AllocatedImage Engine::createImage(
+        const VkExtent3D size,
+        const VkFormat format,
+        const VkImageUsageFlags usage,
+        bool mipmapped 
+    )
+    {
+        AllocatedImage new_image;
+    
+        new_image.image_format = format;
+        new_image.image_extent = size;
+    
+        VkImageCreateInfo image_info {
+            generateImageCreateInfo(format, usage, size)
+        };
+    
+        if(mipmapped)
+        {
+            image_info.mipLevels = static_cast<std::uint32_t>(
+                std::floor(std::log2(std::max(size.width, size.height))) + 1
+            );
+        }
+    
+        VmaAllocationCreateInfo allocate_info {};
+    
+        allocate_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        allocate_info.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+        check(
+            vmaCreateImage(
+                allocator, &image_info, &allocate_info, &new_image.image, &new_image.allocation, nullptr
+            )
+        );
+    
+        VkImageAspectFlags aspect_flag {VK_IMAGE_ASPECT_COLOR_BIT};
+    
+        if(format == VK_FORMAT_D32_SFLOAT)
+        {
+            aspect_flag = VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+    
+        VkImageViewCreateInfo view_info {
+            generateImageViewCreateInfo(
+                format, new_image.image, aspect_flag
+            )
+        };
+    
+        view_info.subresourceRange.levelCount = image_info.mipLevels;
+    
+        check(
+            vkCreateImageView(
+                logical_device, &view_info, nullptr, &new_image.image_view
+            )
+        );
+
+        image_states.track(new_image);
+    
+        return new_image;
+    }
+    
+    AllocatedImage Engine::createImage(
+        const void* const data,
+        const VkExtent3D size,
+        const VkFormat format,
+        const VkImageUsageFlags usage,
+        bool mipmapped            
+    )
+    {
+        std::size_t data_size {
+            size.depth * size.width * size.height * 4
+        };
+    
+        AllocatedImage new_image {
+            createImage(
+                size, 
+                format,
+                usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                mipmapped
+            )
+        };
+
+        new_image.upload_ticket = upload_service.uploadImage(
+            new_image.image, size, data, data_size
+        );
+
+        // The upload leaves it shader-readable, with visibility provided by the ownership acquire
+        image_states.track(new_image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    
+        return new_image;
+    }
+    
+    void Engine::destroyImage(const AllocatedImage& image)
+    {
+        image_states.untrack(image.image);
+
+        vkDestroyImageView(logical_device, image.image_view, nullptr);
+        vmaDestroyImage(allocator, image.image, image.allocation);
+    }
+    
+    DescriptorBinding Engine::writeSceneDescriptor()
+    {
+        const auto write_start {std::chrono::steady_clock::now()};
+
+        const TransientArena::Allocation scene_data_allocation {
+            getCurrentFrame().transient_arena.allocate(sizeof(SceneData))
+        };
+
+        SceneData* scene_uniform_data {
+            reinterpret_cast<SceneData*>(scene_data_allocation.data)
+        };
+
+        *scene_uniform_data = scene_data;
+
+        DescriptorWriter& writer {scene_descriptor_writer};
+
+        writer.clear();
+
+        writer.writeBuffer(
+            0, 
+            scene_data_allocation.buffer, 
+            sizeof(SceneData), 
+            scene_data_allocation.offset, 
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+        );
+
+        DescriptorBinding global_descriptor {};
+
+        if(settings.descriptor_buffers)
+        {
+            global_descriptor.offset = writer.writeDescriptorBuffer(
+                logical_device, scene_data_descriptor_layout, getCurrentFrame().descriptor_buffer
+            );
+        }
+        // Pushed writes are recorded by bindDescriptor, nothing is allocated
+        else if(!settings.push_scene_descriptors)
+        {
+            // The scene data sits at the same arena offset every time the frame comes around
+            global_descriptor.set = getCurrentFrame().descriptor_cache.getDescriptorSet(
+                logical_device,
+                scene_data_descriptor_layout,
+                writer,
+                getCurrentFrame().frame_descriptors
+            );
+        }
+
+        descriptor_write_statistics.addSample(
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - write_start
+            ).count()
+        );
+
+        return global_descriptor;
+    }
+
+    void Engine::bindDescriptorBuffers(const VkCommandBuffer command_buffer)
+    {
+        if(!settings.descriptor_buffers)
+        {
+            return;
+        }
+
+        const std::array<VkDescriptorBufferBindingInfoEXT, 2> binding_infos {
+            getCurrentFrame().descriptor_buffer.getBindingInfo(),
+            material_descriptor_buffer.getBindingInfo()
+        };
+
+        descriptor_buffer_functions.cmd_bind_buffers(
+            command_buffer, static_cast<std::uint32_t>(binding_infos.size()), binding_infos.data()
+        );
+    }
+
+    void Engine::bindDescriptor(
+        const VkCommandBuffer command_buffer,
+        const VkPipelineLayout layout,
+        const std::uint32_t set_index,
+        const DescriptorBinding& descriptor
+    )
+    {
+        if(settings.push_scene_descriptors && set_index == 0)
+        {
+            scene_descriptor_writer.pushDescriptorSet(
+                command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set_index
+            );
+
+            return;
+        }
+
+        if(!settings.descriptor_buffers)
+        {
+            vkCmdBindDescriptorSets(
+                command_buffer,
+                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                layout,
+                set_index,
+                1,
+                &descriptor.set,
+                0,
+                nullptr
+            );
+
+            return;
+        }
+
+        // Set 0 is the per-frame scene data, every other set belongs to a material
+        const std::uint32_t buffer_index {
+            set_index == 0? frame_descriptor_buffer_index : material_descriptor_buffer_index
+        };
+
+        descriptor_buffer_functions.cmd_set_offsets(
+            command_buffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            layout,
+            set_index,
+            1,
+            &buffer_index,
+            &descriptor.offset
+        );
+    }
+
+    void Engine::setViewportAndScissor(const VkCommandBuffer command_buffer)
+    {
+        VkViewport viewport {};
+    
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.width = draw_extent.width;
+        viewport.height = draw_extent.height;
+        viewport.minDepth = 0.f;
+        viewport.maxDepth = 1.f;
+    
+        vkCmdSetViewport(
+            command_buffer,
+            0,
+            1,
+            &viewport
+        );
+    
+        VkRect2D scissor {};
+    
+        scissor.offset.x = 0;
+        scissor.offset.y = 0;
+        scissor.extent.width = draw_extent.width;
+        scissor.extent.height = draw_extent.height;
+    
+        vkCmdSetScissor(
+            command_buffer, 0, 1, &scissor
+        );
+    }
+
+    void Engine::drawGeometry(const VkCommandBuffer command_buffer)
+    {
+        const auto record_start {std::chrono::steady_clock::now()};
+
+        const DescriptorBinding global_descriptor {writeSceneDescriptor()};
+
+        VkRenderingAttachmentInfo color_attachment {
+            generateAttachmentInfo(
+                draw_image.image_view,
+                nullptr,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+            )
+        };
+    
+        VkRenderingAttachmentInfo depth_attachment {
+            generateDepthAttachmentInfo(
+                depth_image.image_view,
+                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
+            )
+        };
+    
+        VkRenderingInfo render_info {
+            generateRenderingInfo(
+                draw_extent, &color_attachment, &depth_attachment
+            )
+        };
+
+        render_info.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    
+        gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "geometry");
+
+        vkCmdBeginRendering(command_buffer, &render_info);
+
+        sortDrawOrder();
+        sortTransparentOrder();
+        buildInstanceGroups(draw_order);
+
+        const std::span<const InstanceGroup> draws {instance_groups};
+
+        const std::size_t chunk_count {
+            std::clamp<std::size_t>(
+                draws.size() / min_draws_per_recording_thread, 1, recording_thread_count
+            )
+        };
+
+        const std::size_t chunk_size {(draws.size() + chunk_count - 1) / chunk_count};
+
+        const auto& secondaries {getCurrentFrame().recording_command_buffers};
+
+        const auto getChunk {
+            [&](const std::size_t chunk)
+            {
+                const std::size_t chunk_begin {std::min(chunk * chunk_size, draws.size())};
+                const std::size_t chunk_end {std::min(chunk_begin + chunk_size, draws.size())};
+
+                return draws.subspan(chunk_begin, chunk_end - chunk_begin);
+            }
+        };
+
+        // The last entry counts the transparent draws
+        recording_statistics.assign(chunk_count + 1, DrawStatistics{});
+
+        JobCounter recordings;
+
+        // The calling thread records the first chunk itself
+        for(std::size_t chunk {1}; chunk < chunk_count; ++chunk)
+        {
+            job_system.submit(
+                [&, chunk]
+                {
+                    recordGeometry(
+                        secondaries[chunk], getChunk(chunk), global_descriptor, recording_statistics[chunk]
+                    );
+                },
+                &recordings
+            );
+        }
+
+        recordGeometry(secondaries[0], getChunk(0), global_descriptor, recording_statistics[0]);
+
+        // Shares the first recording pool, so it stays on the thread that recorded the first chunk
+        if(!transparent_groups.empty())
+        {
+            recordGeometry(
+                getCurrentFrame().transparent_command_buffer,
+                transparent_groups,
+                global_descriptor,
+                recording_statistics.back()
+            );
+        }
+
+        job_system.wait(recordings);
+
+        draw_statistics = {};
+
+        for(const auto& statistics : recording_statistics)
+        {
+            draw_statistics.draw_count += statistics.draw_count;
+            draw_statistics.instance_count += statistics.instance_count;
+            draw_statistics.pipeline_binds += statistics.pipeline_binds;
+            draw_statistics.descriptor_set_binds += statistics.descriptor_set_binds;
+            draw_statistics.material_set_binds += statistics.material_set_binds;
+            draw_statistics.index_buffer_binds += statistics.index_buffer_binds;
+            draw_statistics.redundant_binds += statistics.redundant_binds;
+            draw_statistics.push_constant_updates += statistics.push_constant_updates;
+        }
+
+        vkCmdExecuteCommands(
+            command_buffer, static_cast<std::uint32_t>(chunk_count), secondaries.data()
+        );
+
+        // Blended over every opaque draw
+        if(!transparent_groups.empty())
+        {
+            vkCmdExecuteCommands(command_buffer, 1, &getCurrentFrame().transparent_command_buffer);
+        }
+
+        vkCmdEndRendering(command_buffer);
+
+        gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+
+        record_statistics.addSample(
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - record_start
+            ).count()
+        );
+    }
+
+    std::uint64_t Engine::getStateSortKey(const RenderObject& object)
+    {
+        const auto getSortId {
+            [](auto& ids, const auto handle, const std::uint64_t bits)
+            {
+                const auto [id, inserted] {ids.try_emplace(handle, ids.size())};
+
+                // Ids past the field width alias, keys only order draws and never identify state
+                return id->second & ((std::uint64_t{1} << bits) - 1);
+            }
+        };
+
+        std::uint64_t key {
+            getSortId(pipeline_sort_ids, object.material->pipeline->pipeline, sort_pipeline_bits)
+        };
+
+        // Bindless materials share one set, their table indices are already dense
+        const std::uint64_t material {
+            settings.bindless_materials
+                ? object.material->material_index & ((std::uint64_t{1} << sort_material_bits) - 1)
+                : getSortId(
+                    material_sort_ids,
+                    settings.descriptor_buffers
+                        ? object.material->descriptor_offset
+                        : std::bit_cast<std::uint64_t>(object.material->descriptor_set),
+                    sort_material_bits
+                )
+        };
+
+        key = (key << sort_material_bits) | material;
+
+        return key;
+    }
+
+    void Engine::sortDrawOrder()
+    {
+        pipeline_sort_ids.clear();
+        material_sort_ids.clear();
+        geometry_sort_ids.clear();
+
+        draw_order.clear();
+
+        const auto& objects {main_draw_context.opaque_surfaces};
+
+        frustum_culler.cull(scene_data.view_proj, objects, visible_surfaces);
+
+        for(const auto index : visible_surfaces)
+        {
+            const RenderObject& object {objects[index]};
+
+            if(!upload_service.isReady(object.upload_ticket))
+            {
+                continue;
+            }
+
+            const float view_depth {
+                std::max(-(scene_data.view * object.transform[3]).z, 0.f)
+            };
+
+            // Non-negative floats order the same as their bit patterns, the low mantissa bits are dropped
+            const std::uint64_t depth {
+                std::bit_cast<std::uint32_t>(view_depth) >> (31 - sort_depth_bits)
+            };
+
+            const std::uint64_t geometry {
+                (std::uint64_t{object.first_index} << 32) | static_cast<std::uint32_t>(object.vertex_offset)
+            };
+
+            const auto [geometry_id, inserted] {
+                geometry_sort_ids.try_emplace(geometry, geometry_sort_ids.size())
+            };
+
+            // Repeated surfaces end up adjacent, front to back within the same surface
+            std::uint64_t key {getStateSortKey(object)};
+
+            key = (key << sort_geometry_bits)
+                | (geometry_id->second & ((std::uint64_t{1} << sort_geometry_bits) - 1));
+
+            key = (key << sort_depth_bits) | depth;
+
+            draw_order.push_back({key, index});
+        }
+
+        radixSort(draw_order, draw_order_scratch);
+    }
+
+    void Engine::sortTransparentOrder()
+    {
+        transparent_order.clear();
+
+        const auto& objects {main_draw_context.transparent_surfaces};
+
+        transparent_culler.cull(scene_data.view_proj, objects, visible_surfaces);
+
+        constexpr std::uint64_t depth_mask {(std::uint64_t{1} << sort_depth_bits) - 1};
+
+        for(const auto index : visible_surfaces)
+        {
+            const RenderObject& object {objects[index]};
+
+            if(!upload_service.isReady(object.upload_ticket))
+            {
+                continue;
+            }
+
+            const float view_depth {
+                std::max(-(scene_data.view * object.transform[3]).z, 0.f)
+            };
+
+            const std::uint64_t depth {
+                std::bit_cast<std::uint32_t>(view_depth) >> (31 - sort_depth_bits)
+            };
+
+            // Inverted so the farthest surface sorts first, only the depth digits take a radix pass
+            transparent_order.push_back({depth_mask - depth, index});
+        }
+
+        radixSort(transparent_order, draw_order_scratch);
+    }
+
+    void Engine::buildInstanceGroups(const std::span<const SortItem> opaque_order)
+    {
+        FrameData& frame {getCurrentFrame()};
+
+        const std::size_t instance_count {opaque_order.size() + transparent_order.size()};
+
+        reserveInstanceBuffer(frame, instance_count);
+
+        glm::mat4* const transforms {
+            reinterpret_cast<glm::mat4*>(frame.instance_buffer.allocation_info.pMappedData)
+        };
+
+        const auto& opaque_objects {main_draw_context.opaque_surfaces};
+        const auto& transparent_objects {main_draw_context.transparent_surfaces};
+
+        job_system.parallelFor(
+            instance_count,
+            instances_per_copy_job,
+            [&](const std::size_t begin, const std::size_t end)
+            {
+                for(std::size_t instance {begin}; instance < end; ++instance)
+                {
+                    transforms[instance] = instance < opaque_order.size()
+                        ? opaque_objects[opaque_order[instance].value].transform
+                        : transparent_objects[transparent_order[instance - opaque_order.size()].value].transform;
+                }
+            }
+        );
+
+        instance_groups.clear();
+        transparent_groups.clear();
+
+        appendInstanceGroups(opaque_objects, opaque_order, 0, instance_groups);
+
+        // Adjacent copies of a surface keep their back to front order inside one instanced draw
+        appendInstanceGroups(
+            transparent_objects,
+            transparent_order,
+            static_cast<std::uint32_t>(opaque_order.size()),
+            transparent_groups
+        );
+
+        if(instance_count != 0)
+        {
+            check(
+                vmaFlushAllocation(
+                    allocator, frame.instance_buffer.allocation, 0, instance_count * sizeof(glm::mat4)
+                )
+            );
+        }
+    }
+
+    void Engine::appendInstanceGroups(
+        const std::span<const RenderObject> objects,
+        const std::span<const SortItem> order,
+        const std::uint32_t first_instance,
+        std::vector<InstanceGroup>& groups
+    )
+    {
+        for(std::uint32_t slot {}; slot < order.size(); ++slot)
+        {
+            const RenderObject& object {objects[order[slot].value]};
+
+            const RenderObject* const previous {
+                groups.empty()? nullptr : groups.back().object
+            };
+
+            if(
+                !previous
+                || !settings.instanced_draws
+                || previous->material->pipeline != object.material->pipeline
+                || previous->material->descriptor_set != object.material->descriptor_set
+                || previous->material->descriptor_offset != object.material->descriptor_offset
+                || previous->material->material_index != object.material->material_index
+                || previous->first_index != object.first_index
+                || previous->index_count != object.index_count
+                || previous->vertex_offset != object.vertex_offset
+            )
+            {
+                groups.push_back(
+                    InstanceGroup{
+                        .object = &object,
+                        .first_instance = first_instance + slot,
+                        .instance_count = 0
+                    }
+                );
+            }
+
+            ++groups.back().instance_count;
+        }
+    }
+
+    void Engine::reserveInstanceBuffer(FrameData& frame, const std::size_t instance_count)
     {
-        VkClearColorValue clear_value;
-    
-        clear_value = {
-            {0.0f, 0.0f, 0.0f, 1.0f}
-        };
-    
-        VkImageSubresourceRange clear_range {
-            generateImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT)
-        };
-    
-        vkCmdClearColorImage(
-            command_buffer,
-            draw_image.image,
-            VK_IMAGE_LAYOUT_GENERAL,
-            &clear_value,
-            1,
-            &clear_range
+        if(instance_count <= frame.instance_capacity)
+        {
+            return;
+        }
+
+        // Only called after the frame's fence wait, nothing in flight uses the old buffer
+        if(frame.instance_capacity != 0)
+        {
+            destroyBuffer(frame.instance_buffer);
+        }
+
+        frame.instance_capacity = std::bit_ceil(std::max(instance_count, min_instance_capacity));
+
+        frame.instance_buffer = createBuffer(
+            frame.instance_capacity * sizeof(glm::mat4),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU
         );
+
+        frame.instance_buffer_address = getBufferDeviceAddress(frame.instance_buffer.buffer);
     }
-    
-    void PipelineBuilder::enableDepthTest(
-        const bool depth_write_enable, const VkCompareOp op
-    )
+
+    void Engine::syncGpuScene()
     {
-        depth_stencil.depthTestEnable = VK_TRUE;
-        depth_stencil.depthWriteEnable = depth_write_enable;
-        depth_stencil.depthCompareOp = op;
-        depth_stencil.depthBoundsTestEnable = VK_FALSE;
-        depth_stencil.stencilTestEnable = VK_FALSE;
-        depth_stencil.front = {};
-        depth_stencil.back = {};
-        depth_stencil.minDepthBounds = 0.f;
-        depth_stencil.maxDepthBounds = 1.f;
+        if(gpu_scene_dirty)
+        {
+            const std::optional<GpuScene::ObjectBuffer> retired {
+                gpu_scene.update(
+                    main_draw_context.opaque_surfaces,
+                    geometry_pool.getVertexBufferAddress(),
+                    upload_service
+                )
+            };
+
+            if(retired)
+            {
+                retireResource(
+                    [this, buffer = *retired]
+                    {
+                        if(debug) std::println("Destroying retired GPU object buffer");
+
+                        gpu_scene.destroyBuffer(buffer);
+                    }
+                );
+            }
+
+            gpu_scene_dirty = false;
+        }
+
+        gpu_scene.promotePending(upload_service);
     }
-    
-    AllocatedImage Engine::createImage(
-        const VkExtent3D size,
-        const VkFormat format,
-        const VkImageUsageFlags usage,
-        bool mipmapped 
+
+    void Engine::reserveGpuScene(FrameData& frame, const std::size_t command_count, const std::size_t batch_count)
+    {
+        // Only ever grown, a frame without objects keeps its buffers
+        if(command_count <= frame.gpu_command_capacity && batch_count <= frame.gpu_batch_capacity)
+        {
+            return;
+        }
+
+        // Only called after the frame's fence wait, nothing in flight uses the old buffers
+        if(frame.gpu_command_capacity != 0)
+        {
+            destroyBuffer(frame.draw_command_buffer);
+            destroyBuffer(frame.draw_count_buffer);
+        }
+
+        frame.gpu_command_capacity = std::bit_ceil(std::max(command_count, frame.gpu_command_capacity));
+        frame.gpu_batch_capacity = std::bit_ceil(
+            std::max({batch_count, frame.gpu_batch_capacity, min_gpu_batch_capacity})
+        );
+
+        frame.draw_command_buffer = createBuffer(
+            frame.gpu_command_capacity * sizeof(VkDrawIndexedIndirectCommand),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+            | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+
+        // One count per batch
+        frame.draw_count_buffer = createBuffer(
+            frame.gpu_batch_capacity * sizeof(std::uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+    }
+
+    void Engine::addGeometryPasses(
+        const RenderGraph::ResourceHandle draw_target,
+        const RenderGraph::ResourceHandle depth_target
     )
     {
-        AllocatedImage new_image;
-    
-        new_image.image_format = format;
-        new_image.image_extent = size;
-    
-        VkImageCreateInfo image_info {
-            generateImageCreateInfo(format, usage, size)
-        };
-    
-        if(mipmapped)
+        if(!settings.gpu_driven)
         {
-            image_info.mipLevels = static_cast<std::uint32_t>(
-                std::floor(std::log2(std::max(size.width, size.height))) + 1
+            render_graph.addPass(
+                "geometry",
+                {
+                    {draw_target, ResourceUsage::ColorAttachment},
+                    {depth_target, ResourceUsage::DepthAttachment}
+                },
+                [this](const VkCommandBuffer command_buffer)
+                {
+                    drawGeometry(command_buffer);
+                }
             );
+
+            return;
         }
-    
-        VmaAllocationCreateInfo allocate_info {};
-    
-        allocate_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-        allocate_info.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    
-        check(
-            vmaCreateImage(
-                allocator, &image_info, &allocate_info, &new_image.image, &new_image.allocation, nullptr
-            )
-        );
-    
-        VkImageAspectFlags aspect_flag {VK_IMAGE_ASPECT_COLOR_BIT};
-    
-        if(format == VK_FORMAT_D32_SFLOAT)
+
+        syncGpuScene();
+
+        if(gpu_scene.getStatistics().live_objects == 0)
         {
-            aspect_flag = VK_IMAGE_ASPECT_DEPTH_BIT;
+            render_graph.addPass(
+                "geometry",
+                {
+                    {draw_target, ResourceUsage::ColorAttachment},
+                    {depth_target, ResourceUsage::DepthAttachment}
+                },
+                [this](const VkCommandBuffer command_buffer)
+                {
+                    drawGeometryIndirect(command_buffer);
+                }
+            );
+
+            return;
         }
-    
-        VkImageViewCreateInfo view_info {
-            generateImageViewCreateInfo(
-                format, new_image.image, aspect_flag
-            )
+
+        FrameData& frame {getCurrentFrame()};
+
+        reserveGpuScene(frame, gpu_scene.getCommandCapacity(), gpu_scene.getBatches().size());
+
+        const RenderGraph::ResourceHandle object_target {
+            render_graph.importBuffer(gpu_scene.getObjectBuffer(), gpu_scene.getAccessState())
         };
-    
-        view_info.subresourceRange.levelCount = image_info.mipLevels;
-    
-        check(
-            vkCreateImageView(
-                logical_device, &view_info, nullptr, &new_image.image_view
-            )
+
+        const RenderGraph::ResourceHandle command_target {
+            render_graph.importBuffer(frame.draw_command_buffer.buffer)
+        };
+
+        const RenderGraph::ResourceHandle count_target {
+            render_graph.importBuffer(frame.draw_count_buffer.buffer)
+        };
+
+        // Unchanged frames skip the upload entirely
+        if(gpu_scene.hasDirtyObjects())
+        {
+            render_graph.addPass(
+                "upload_objects",
+                {
+                    {object_target, ResourceUsage::TransferDestination}
+                },
+                [this](const VkCommandBuffer command_buffer)
+                {
+                    gpu_scene.recordUpload(command_buffer, frame_number % frame_overlap);
+                }
+            );
+        }
+
+        render_graph.addPass(
+            "clear_draw_counts",
+            {
+                {count_target, ResourceUsage::TransferDestination}
+            },
+            [this](const VkCommandBuffer command_buffer)
+            {
+                vkCmdFillBuffer(
+                    command_buffer,
+                    getCurrentFrame().draw_count_buffer.buffer,
+                    0,
+                    gpu_scene.getBatches().size() * sizeof(std::uint32_t),
+                    0
+                );
+            }
+        );
+
+        render_graph.addPass(
+            "cull",
+            {
+                {object_target, ResourceUsage::StorageBufferRead},
+                {count_target, ResourceUsage::StorageBufferWrite},
+                {command_target, ResourceUsage::StorageBufferWrite}
+            },
+            [this](const VkCommandBuffer command_buffer)
+            {
+                const FrameData& frame {getCurrentFrame()};
+
+                gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "cull");
+
+                gpu_culler.record(
+                    command_buffer,
+                    scene_data.view_proj,
+                    gpu_scene.getObjectBufferAddress(),
+                    getBufferDeviceAddress(frame.draw_command_buffer.buffer),
+                    getBufferDeviceAddress(frame.draw_count_buffer.buffer),
+                    gpu_scene.getSlotCount()
+                );
+
+                gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+            }
+        );
+
+        render_graph.addPass(
+            "geometry",
+            {
+                {draw_target, ResourceUsage::ColorAttachment},
+                {depth_target, ResourceUsage::DepthAttachment},
+                {object_target, ResourceUsage::StorageBufferRead},
+                {command_target, ResourceUsage::IndirectRead},
+                {count_target, ResourceUsage::IndirectRead}
+            },
+            [this](const VkCommandBuffer command_buffer)
+            {
+                drawGeometryIndirect(command_buffer);
+            }
         );
-    
-        return new_image;
     }
-    
-    AllocatedImage Engine::createImage(
-        const void* const data,
-        const VkExtent3D size,
-        const VkFormat format,
-        const VkImageUsageFlags usage,
-        bool mipmapped            
-    )
+
+    void Engine::drawGeometryIndirect(const VkCommandBuffer command_buffer)
     {
-        std::size_t data_size {
-            size.depth * size.width * size.height * 4
+        const auto record_start {std::chrono::steady_clock::now()};
+
+        const DescriptorBinding global_descriptor {writeSceneDescriptor()};
+
+        VkRenderingAttachmentInfo color_attachment {
+            generateAttachmentInfo(
+                draw_image.image_view,
+                nullptr,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+            )
         };
     
-        AllocatedBuffer upload_buffer {
-            createBuffer(
-                data_size,
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VMA_MEMORY_USAGE_CPU_TO_GPU
+        VkRenderingAttachmentInfo depth_attachment {
+            generateDepthAttachmentInfo(
+                depth_image.image_view,
+                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
             )
         };
     
-        std::memcpy(upload_buffer.allocation_info.pMappedData, data, data_size);
-    
-        AllocatedImage new_image {
-            createImage(
-                size, 
-                format,
-                usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-                mipmapped
+        VkRenderingInfo render_info {
+            generateRenderingInfo(
+                draw_extent, &color_attachment, &depth_attachment
             )
         };
-    
-        immediateSubmit(
-            [&, this](const VkCommandBuffer command_buffer)
+
+        gpu_profiler.beginPass(command_buffer, getCurrentFrame().timestamps, "geometry");
+
+        vkCmdBeginRendering(command_buffer, &render_info);
+
+        setViewportAndScissor(command_buffer);
+
+        const FrameData& frame {getCurrentFrame()};
+
+        draw_statistics = {};
+
+        vkCmdBindIndexBuffer(command_buffer, geometry_pool.getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+        ++draw_statistics.index_buffer_binds;
+
+        bindDescriptorBuffers(command_buffer);
+
+        VkPipeline bound_pipeline {};
+        VkPipelineLayout bound_layout {};
+        std::optional<DescriptorBinding> bound_material;
+
+        for(const std::uint32_t batch_index : gpu_scene.getBatchOrder())
+        {
+            const GpuScene::Batch& batch {gpu_scene.getBatches()[batch_index]};
+
+            if(batch.object_count == 0)
+            {
+                continue;
+            }
+
+            const MaterialInstance& material {batch.material};
+
+            if(material.pipeline->indirect_pipeline != bound_pipeline)
+            {
+                vkCmdBindPipeline(
+                    command_buffer,
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    material.pipeline->indirect_pipeline
+                );
+
+                bound_pipeline = material.pipeline->indirect_pipeline;
+
+                ++draw_statistics.pipeline_binds;
+            }
+
+            if(material.pipeline->layout != bound_layout)
+            {
+                bindDescriptor(command_buffer, material.pipeline->layout, 0, global_descriptor);
+
+                DrawPushCostants push_constants {};
+
+                push_constants.vertex_buffer = geometry_pool.getVertexBufferAddress();
+                push_constants.instance_buffer = gpu_scene.getObjectBufferAddress();
+
+                vkCmdPushConstants(
+                    command_buffer,
+                    material.pipeline->layout,
+                    VK_SHADER_STAGE_VERTEX_BIT,
+                    0,
+                    sizeof(DrawPushCostants),
+                    &push_constants
+                );
+
+                bound_layout = material.pipeline->layout;
+                bound_material.reset();
+
+                ++draw_statistics.descriptor_set_binds;
+            }
+
+            const DescriptorBinding material_descriptor {material.descriptor_set, material.descriptor_offset};
+
+            // Bindless batches only differ in pipeline and keep the shared set
+            if(material_descriptor != bound_material)
+            {
+                bindDescriptor(command_buffer, material.pipeline->layout, 1, material_descriptor);
+
+                bound_material = material_descriptor;
+
+                ++draw_statistics.descriptor_set_binds;
+                ++draw_statistics.material_set_binds;
+            }
+            else
             {
-                changeImageLayout(
-                    command_buffer, 
-                    new_image.image, 
-                    VK_IMAGE_LAYOUT_UNDEFINED, 
-                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-                );
-    
-                VkBufferImageCopy copy_region {};
-    
-                copy_region.bufferOffset = 0;
-                copy_region.bufferRowLength = 0;
-                copy_region.bufferImageHeight = 0;
-    
-                copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                copy_region.imageSubresource.mipLevel = 0;
-                copy_region.imageSubresource.baseArrayLayer = 0;
-                copy_region.imageSubresource.layerCount = 1;
-                copy_region.imageExtent = size;
-    
-                vkCmdCopyBufferToImage(
-                    command_buffer, 
-                    upload_buffer.buffer, 
-                    new_image.image, 
-                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
-                    1,
-                    &copy_region 
-                );
-    
-                changeImageLayout(
-                    command_buffer, 
-                    new_image.image, 
-                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
-                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-                );
+                ++draw_statistics.redundant_binds;
             }
+
+            vkCmdDrawIndexedIndirectCount(
+                command_buffer,
+                frame.draw_command_buffer.buffer,
+                batch.command_offset * sizeof(VkDrawIndexedIndirectCommand),
+                frame.draw_count_buffer.buffer,
+                batch_index * sizeof(std::uint32_t),
+                batch.command_capacity,
+                sizeof(VkDrawIndexedIndirectCommand)
+            );
+
+            ++draw_statistics.draw_count;
+        }
+
+        // Transparent surfaces are culled and sorted on the CPU, their instances fill the instance buffer
+        sortTransparentOrder();
+        buildInstanceGroups({});
+
+        recordDraws(command_buffer, transparent_groups, global_descriptor, draw_statistics);
+
+        vkCmdEndRendering(command_buffer);
+
+        gpu_profiler.endPass(command_buffer, getCurrentFrame().timestamps);
+
+        record_statistics.addSample(
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - record_start
+            ).count()
         );
-    
-        destroyBuffer(upload_buffer);
-    
-        return new_image;
     }
-    
-    void Engine::destroyImage(const AllocatedImage& image)
+
+    VkDeviceAddress Engine::getBufferDeviceAddress(const VkBuffer buffer) const
     {
-        vkDestroyImageView(logical_device, image.image_view, nullptr);
-        vmaDestroyImage(allocator, image.image, image.allocation);
-    }
+        VkBufferDeviceAddressInfo device_address_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr
+        };
     
-    void Engine::drawGeometry(const VkCommandBuffer command_buffer)
+        device_address_info.buffer = buffer;
+    
+        return vkGetBufferDeviceAddress(logical_device, &device_address_info);
+    }
+
+    void Engine::recordGeometry(
+        const VkCommandBuffer command_buffer,
+        const std::span<const InstanceGroup> groups,
+        const DescriptorBinding& global_descriptor,
+        DrawStatistics& statistics
+    )
     {
-        VkRenderingAttachmentInfo color_attachment {
-            generateAttachmentInfo(
-                draw_image.image_view,
-                nullptr,
-                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-            )
+        VkCommandBufferInheritanceRenderingInfo inheritance_rendering_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .pNext = nullptr
         };
-    
-        VkRenderingAttachmentInfo depth_attachment {
-            generateDepthAttachmentInfo(
-                depth_image.image_view,
-                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
-            )
+
+        inheritance_rendering_info.colorAttachmentCount = 1;
+        inheritance_rendering_info.pColorAttachmentFormats = &draw_image.image_format;
+        inheritance_rendering_info.depthAttachmentFormat = depth_image.image_format;
+        inheritance_rendering_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkCommandBufferInheritanceInfo inheritance_info {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = &inheritance_rendering_info
         };
-    
-        VkRenderingInfo render_info {
-            generateRenderingInfo(
-                draw_extent, &color_attachment, &depth_attachment
+
+        VkCommandBufferBeginInfo begin_info {
+            generateCommandBufferBeginInfo(
+                VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT
             )
         };
-    
-        vkCmdBeginRendering(command_buffer, &render_info);
-    
-        VkViewport viewport {};
-    
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.width = draw_extent.width;
-        viewport.height = draw_extent.height;
-        viewport.minDepth = 0.f;
-        viewport.maxDepth = 1.f;
-    
-        vkCmdSetViewport(
-            command_buffer,
-            0,
-            1,
-            &viewport
+
+        begin_info.pInheritanceInfo = &inheritance_info;
+
+        check(
+            vkBeginCommandBuffer(command_buffer, &begin_info)
         );
-    
-        VkRect2D scissor {};
-    
-        scissor.offset.x = 0;
-        scissor.offset.y = 0;
-        scissor.extent.width = draw_extent.width;
-        scissor.extent.height = draw_extent.height;
-    
-        vkCmdSetScissor(
-            command_buffer, 0, 1, &scissor
+
+        setViewportAndScissor(command_buffer);
+
+        bindDescriptorBuffers(command_buffer);
+
+        vkCmdBindIndexBuffer(command_buffer, geometry_pool.getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+        ++statistics.index_buffer_binds;
+
+        recordDraws(command_buffer, groups, global_descriptor, statistics);
+
+        check(
+            vkEndCommandBuffer(command_buffer)
         );
-        
-        AllocatedBuffer scene_data_buffer {
-            createBuffer(
-                sizeof(SceneData), 
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                VMA_MEMORY_USAGE_CPU_TO_GPU
-            )
-        };
+    }
 
-        getCurrentFrame().resource_cleaner.addCleaner(
-            [=, this]
+    void Engine::recordDraws(
+        const VkCommandBuffer command_buffer,
+        const std::span<const InstanceGroup> groups,
+        const DescriptorBinding& global_descriptor,
+        DrawStatistics& statistics
+    )
+    {
+        DrawPushCostants push_constants {};
+
+        push_constants.vertex_buffer = geometry_pool.getVertexBufferAddress();
+        push_constants.instance_buffer = getCurrentFrame().instance_buffer_address;
+
+        VkPipeline bound_pipeline {};
+        VkPipelineLayout bound_layout {};
+        std::optional<DescriptorBinding> bound_material;
+
+        std::uint32_t bound_material_index {};
+
+        for(const auto& group : groups)
+        {
+            const RenderObject& object {*group.object};
+
+            const MaterialPipeline& pipeline {*object.material->pipeline};
+
+            push_constants.material_index = object.material->material_index;
+
+            if(pipeline.pipeline != bound_pipeline)
             {
-                if(debug) std::println("Destroying buffer");
+                vkCmdBindPipeline(
+                    command_buffer,
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    pipeline.pipeline
+                );
 
-                destroyBuffer(scene_data_buffer);
+                bound_pipeline = pipeline.pipeline;
+
+                ++statistics.pipeline_binds;
+            }
+            else
+            {
+                ++statistics.redundant_binds;
             }
-        );
 
-        SceneData* scene_uniform_data {
-            reinterpret_cast<SceneData*>(scene_data_buffer.allocation->GetMappedData())
-        };
+            // Set 0 stays bound across pipelines sharing a layout
+            if(pipeline.layout != bound_layout)
+            {
+                bindDescriptor(command_buffer, pipeline.layout, 0, global_descriptor);
 
-        *scene_uniform_data = scene_data;
-    
-        VkDescriptorSet global_descriptor {
-            getCurrentFrame().frame_descriptors.allocate(logical_device, scene_data_descriptor_layout)
-        };
+                vkCmdPushConstants(
+                    command_buffer,
+                    pipeline.layout,
+                    VK_SHADER_STAGE_VERTEX_BIT,
+                    0,
+                    sizeof(DrawPushCostants),
+                    &push_constants
+                );
 
-        DescriptorWriter writer;
+                bound_layout = pipeline.layout;
+                bound_material.reset();
+                bound_material_index = push_constants.material_index;
 
-        writer.writeBuffer(
-            0, 
-            scene_data_buffer.buffer, 
-            sizeof(SceneData), 
-            0, 
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
-        );
+                ++statistics.descriptor_set_binds;
+            }
+            else
+            {
+                ++statistics.redundant_binds;
+            }
 
-        writer.updateDescriptorSet(logical_device, global_descriptor);
+            const DescriptorBinding material_descriptor {
+                object.material->descriptor_set, object.material->descriptor_offset
+            };
 
-        for(const auto& object : main_draw_context.opaque_surfaces)
-        {
-            vkCmdBindPipeline(
-                command_buffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                object.material->pipeline->pipeline
-            );
+            if(material_descriptor != bound_material)
+            {
+                bindDescriptor(command_buffer, pipeline.layout, 1, material_descriptor);
 
-            vkCmdBindDescriptorSets(
-                command_buffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                object.material->pipeline->layout,
-                0,
-                1,
-                &global_descriptor,
-                0,
-                nullptr
-            );
+                bound_material = material_descriptor;
 
-            vkCmdBindDescriptorSets(
-                command_buffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                object.material->pipeline->layout,
-                1,
-                1,
-                &object.material->descriptor_set,
-                0,
-                nullptr
-            );
-    
-            vkCmdBindIndexBuffer(command_buffer, object.index_buffer, 0, VK_INDEX_TYPE_UINT32);
-    
-            DrawPushCostants pushConstants;
+                ++statistics.descriptor_set_binds;
+                ++statistics.material_set_binds;
+            }
+            else
+            {
+                ++statistics.redundant_binds;
+            }
+
+            // Bindless materials share set 1, only the index changes between them
+            if(settings.bindless_materials && push_constants.material_index != bound_material_index)
+            {
+                vkCmdPushConstants(
+                    command_buffer,
+                    pipeline.layout,
+                    VK_SHADER_STAGE_VERTEX_BIT,
+                    offsetof(DrawPushCostants, material_index),
+                    sizeof(std::uint32_t),
+                    &push_constants.material_index
+                );
 
-            pushConstants.vertex_buffer = object.vertex_buffer_address;
-            pushConstants.world_matrix = object.transform;
+                bound_material_index = push_constants.material_index;
 
-            vkCmdPushConstants(
+                ++statistics.push_constant_updates;
+            }
+    
+            vkCmdDrawIndexed(
                 command_buffer,
-                object.material->pipeline->layout,
-                VK_SHADER_STAGE_VERTEX_BIT,
-                0,
-                sizeof(DrawPushCostants),
-                &pushConstants
+                object.index_count,
+                group.instance_count,
+                object.first_index,
+                object.vertex_offset,
+                group.first_instance
             );
-    
-            vkCmdDrawIndexed(command_buffer, object.index_count, 1, object.first_index, 0, 0);
-        }
 
-        vkCmdEndRendering(command_buffer);
+            ++statistics.draw_count;
+
+            statistics.instance_count += group.instance_count;
+        }
     }   
     
     AllocatedBuffer Engine::createBuffer(const std::size_t allocate_size, const VkBufferUsageFlags usage, const VmaMemoryUsage memory_usage)
@@ -1374,10 +3415,6 @@ namespace mdsm::vkei
     
     void Engine::immediateSubmit(const std::function<void(const VkCommandBuffer command_buffer)> &&function)
     {
-        check(
-            vkResetFences(logical_device, 1, &immediate_fence)
-        );
-    
         check(
             vkResetCommandBuffer(immediate_command_buffer, 0)
         );
@@ -1402,112 +3439,103 @@ namespace mdsm::vkei
             generateCommandBufferSubmitInfo(immediate_command_buffer)
         };
     
+        const std::uint64_t submission {graphics_timeline.reserveValue()};
+
+        const VkSemaphoreSubmitInfo signal_info {
+            graphics_timeline.generateSignalInfo(submission)
+        };
+    
         VkSubmitInfo2 submit_info {
-            generateSubmitInfo(&command_buffer_submit_info, nullptr, nullptr)
+            generateSubmitInfo(&command_buffer_submit_info, &signal_info, nullptr)
         };
     
         check(
             vkQueueSubmit2(
-                graphics_queue, 1, &submit_info, immediate_fence
+                graphics_queue, 1, &submit_info, VK_NULL_HANDLE
             )
         );
     
-        check(
-            vkWaitForFences(
-                logical_device, 1, &immediate_fence, true, 9'999'999'999
-            )
-        );
+        if(!graphics_timeline.wait(logical_device, submission, 9'999'999'999))
+        {
+            throw VulkanException{VK_TIMEOUT};
+        }
     }
     
-    MeshBuffers Engine::uploadMesh(const std::span<std::uint32_t> indices, const std::span<Vertex> vertices)
+    MeshBuffers Engine::uploadMesh(
+        const std::span<std::uint32_t> indices,
+        const std::span<Vertex> vertices,
+        const std::span<Surface> surfaces
+    )
     {
-        const std::size_t vertex_buffer_size {
-            vertices.size() * sizeof(Vertex)
-        };
-    
-        const std::size_t index_buffer_size {
-            indices.size() * sizeof(std::uint32_t)
-        };
-    
+        for(auto& surface : surfaces)
+        {
+            surface.bounds = computeBounds(indices.subspan(surface.start_index, surface.count), vertices);
+        }
+
+        const auto vertex_count {static_cast<std::uint32_t>(vertices.size())};
+        const auto index_count {static_cast<std::uint32_t>(indices.size())};
+
+        std::optional<GeometryPool::Handle> handle {geometry_pool.allocate(vertex_count, index_count)};
+
+        if(!handle)
+        {
+            const GeometryPool::PoolStatistics statistics {geometry_pool.getStatistics()};
+
+            if(geometry_pool.fitsAfterCompaction(vertex_count, index_count))
+            {
+                relocateGeometry(
+                    static_cast<std::uint32_t>(statistics.vertex_capacity),
+                    static_cast<std::uint32_t>(statistics.index_capacity)
+                );
+            }
+            else
+            {
+                relocateGeometry(
+                    static_cast<std::uint32_t>(
+                        std::max(statistics.vertex_capacity * 2, statistics.used_vertices + vertex_count)
+                    ),
+                    static_cast<std::uint32_t>(
+                        std::max(statistics.index_capacity * 2, statistics.used_indices + index_count)
+                    )
+                );
+            }
+
+            handle = geometry_pool.allocate(vertex_count, index_count);
+        }
+
         MeshBuffers new_surface;
+
+        new_surface.geometry_handle = *handle;
+        new_surface.upload_ticket = geometry_pool.upload(*handle, indices, vertices);
     
-        new_surface.vertex_buffer = createBuffer(
-            vertex_buffer_size,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-            | VK_BUFFER_USAGE_TRANSFER_DST_BIT
-            | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY
-        );
-    
-        VkBufferDeviceAddressInfo device_address_info {
-            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-            .pNext = nullptr
-        };
-    
-        device_address_info.buffer = new_surface.vertex_buffer.buffer;
-    
-        new_surface.vertex_buffer_address = vkGetBufferDeviceAddress(
-            logical_device, &device_address_info
-        );
-    
-        new_surface.index_buffer = createBuffer(
-            index_buffer_size,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT
-            | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY
-        );
-    
-        AllocatedBuffer staging {
-            createBuffer(
-                vertex_buffer_size + index_buffer_size, 
-                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                VMA_MEMORY_USAGE_CPU_ONLY
-            )
-        };
-    
-        void* data {staging.allocation->GetMappedData()};
-    
-        std::memcpy(data, vertices.data(), vertex_buffer_size);
-        std::memcpy(
-            static_cast<char*>(data) + vertex_buffer_size, indices.data(), index_buffer_size
-        );
-    
+        return new_surface;
+    }
+
+    void Engine::relocateGeometry(const std::uint32_t vertex_capacity, const std::uint32_t index_capacity)
+    {
+        // The copies read the pool buffers, uploads into them have to land first
+        upload_service.waitIdle();
+
+        GeometryPool::Buffers old_buffers;
+
         immediateSubmit(
             [&](const VkCommandBuffer command_buffer)
             {
-                VkBufferCopy vertex_copy {};
-    
-                vertex_copy.dstOffset = 0;
-                vertex_copy.srcOffset = 0;
-                vertex_copy.size = vertex_buffer_size;
-    
-                vkCmdCopyBuffer(
-                    command_buffer,
-                    staging.buffer,
-                    new_surface.vertex_buffer.buffer,
-                    1,
-                    &vertex_copy
-                );
-    
-                VkBufferCopy index_copy {};
-    
-                index_copy.dstOffset = 0;
-                index_copy.srcOffset = vertex_buffer_size;
-                index_copy.size = index_buffer_size;
-    
-                vkCmdCopyBuffer(
-                    command_buffer,
-                    staging.buffer,
-                    new_surface.index_buffer.buffer,
-                    1,
-                    &index_copy
-                );
+                old_buffers = geometry_pool.relocate(command_buffer, vertex_capacity, index_capacity);
             }
         );
-    
-        destroyBuffer(staging);
-    
-        return new_surface;
+
+        retireResource(
+            [this, old_buffers]
+            {
+                if(debug) std::println("Destroying retired geometry buffers");
+
+                geometry_pool.destroyBuffers(old_buffers);
+            }
+        );
+
+        // Resident objects hold the old vertex buffer address
+        markSceneDirty();
     }
     
 }
\ No newline at end of file
@@ -1,13 +1,32 @@
 #pragma once
 
+#include "bindless_table.hpp"
+#include "frustum_culler.hpp"
+#include "geometry_pool.hpp"
+#include "gpu_culler.hpp"
+#include "gpu_profiler.hpp"
+#include "gpu_scene.hpp"
+#include "image_state_tracker.hpp"
+#include "job_system.hpp"
 #include "metallic_roughness.hpp"
 #include "node.hpp"
+#include "radix_sort.hpp"
+#include "render_graph.hpp"
 #include "resource_cleaner.hpp"
+#include "rolling_statistics.hpp"
+#include "timeline_semaphore.hpp"
+#include "upload_service.hpp"
 #include <SDL3/SDL_video.h>
 #include <VkBootstrap.h>
+#include <chrono>
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
@@ -15,21 +34,200 @@
 
 namespace mdsm::vkei
 {
+    enum class PresentModePolicy : std::uint8_t
+    {
+        Fifo,
+        FifoRelaxed,
+        Mailbox,
+        Immediate
+    };
+
+    struct EngineSettings
+    {
+        bool headless {};
+
+        // Requires headless
+        bool headless_readback {};
+
+        std::size_t frames_in_flight {2};
+
+        PresentModePolicy present_mode {PresentModePolicy::Fifo};
+
+        // Zero disables the frame-latency limiter
+        std::chrono::microseconds target_frame_time {};
+
+        // Zero starts one job worker per hardware thread, minus the calling thread
+        std::size_t worker_threads {};
+
+        // Zero records on every job worker plus the calling thread
+        std::size_t recording_threads {};
+
+        // Culls on the GPU and draws each state batch with one indirect-count draw
+        bool gpu_driven {};
+
+        // Merges adjacent copies of a surface into one instanced draw, off draws every object
+        // on its own. Ignored by gpu_driven, which writes one indirect command per visible object
+        bool instanced_draws {true};
+
+        // Materials are entries of one bindless set bound once per layout, selected by push constant
+        bool bindless_materials {};
+
+        // Writes descriptors straight into descriptor buffers and binds them by offset
+        // instead of allocating and updating sets, not combined with bindless_materials
+        bool descriptor_buffers {};
+
+        // Pushes the per-frame scene set into each command buffer instead of allocating it,
+        // not combined with descriptor_buffers
+        bool push_scene_descriptors {};
+    };
+
     class Engine
     {
         public:
             friend class MetallicRoughness;
 
+            struct DrawStatistics
+            {
+                std::size_t draw_count;
+
+                // Objects drawn, several per draw when instanced
+                std::size_t instance_count;
+
+                std::size_t pipeline_binds;
+                std::size_t descriptor_set_binds;
+
+                // The set 1 share of descriptor_set_binds
+                std::size_t material_set_binds;
+
+                std::size_t index_buffer_binds;
+
+                // Binds skipped because the state was already bound
+                std::size_t redundant_binds;
+
+                // Bindless material index changes
+                std::size_t push_constant_updates;
+            };
+
+            struct DescriptorCacheStatistics
+            {
+                // Of the most recently drawn frame
+                DescriptorSetCache::CacheStatistics frame;
+
+                DescriptorSetCache::CacheStatistics global;
+                DescriptorSetCache::CacheStatistics material;
+            };
+
+            // Of the last writeMaterials batch
+            struct MaterialWriteStatistics
+            {
+                std::size_t material_count;
+                std::size_t thread_count;
+
+                double milliseconds;
+                double materials_per_second;
+            };
+
             Engine(
                 const std::string_view app_name,
                 const std::size_t window_width,
                 const std::size_t window_height,
                 const std::string_view window_title = "",
-                const bool debug = false
+                const bool debug = false,
+                const EngineSettings& settings = {}
             );
 
+            void waitForNextFrame();
+
             void draw();
 
+            std::vector<std::byte> readFrame();
+
+            std::unordered_map<std::string_view, GpuProfiler::PassStatistics> getGpuPassStatistics() const;
+
+            const RollingStatistics& getFrameWaitStatistics() const;
+
+            std::size_t getFramesInFlight() const;
+
+            std::uint64_t getLastSubmission() const;
+
+            bool isSubmissionComplete(const std::uint64_t submission) const;
+
+            // Returns false if the timeout expired first
+            bool waitForSubmission(const std::uint64_t submission, const std::uint64_t timeout) const;
+
+            VkPresentModeKHR getPresentMode() const;
+
+            void setTargetFrameTime(const std::chrono::microseconds frame_time);
+
+            const RollingStatistics& getPresentLatencyStatistics() const;
+            const RollingStatistics& getCpuFrameStatistics() const;
+
+            const UploadService::UploadStatistics& getUploadStatistics() const;
+
+            const RenderGraph::GraphStatistics& getRenderGraphStatistics() const;
+
+            const DrawStatistics& getDrawStatistics() const;
+
+            // Summed over the opaque and transparent lists
+            FrustumCuller::CullStatistics getCullStatistics() const;
+
+            GeometryPool::PoolStatistics getGeometryStatistics() const;
+
+            // The GPU-driven path only walks the scene graph again after this,
+            // call it whenever nodes, transforms or materials change
+            void markSceneDirty();
+
+            GpuScene::SceneStatistics getGpuSceneStatistics() const;
+
+            // Uploads the geometry and computes the bounds of each surface, the asset can be
+            // shared by any number of mesh nodes
+            std::shared_ptr<MeshAsset> createMesh(
+                std::string name,
+                const std::span<std::uint32_t> indices,
+                const std::span<Vertex> vertices,
+                std::vector<Surface> surfaces
+            );
+
+            const MaterialInstance& getDefaultMaterial() const;
+
+            // Resources for writeMaterials, entry i reads constants[i] from a buffer the engine
+            // owns and samples the default texture
+            std::vector<MetallicRoughness::MaterialResources> createMaterialResources(
+                const std::span<const MetallicRoughness::MaterialConstants> constants
+            );
+
+            // Drawn from the next frame on, a node with the same name is replaced
+            void addNode(std::string name, std::shared_ptr<Node> node);
+
+            BindlessTable::TableStatistics getBindlessStatistics() const;
+
+            // CPU time in milliseconds spent allocating and writing the per-frame scene descriptors
+            const RollingStatistics& getDescriptorWriteStatistics() const;
+
+            // CPU time in milliseconds spent recording the geometry pass, scene descriptor write included
+            const RollingStatistics& getRecordStatistics() const;
+
+            // Writes the materials in parallel on the job system, each thread allocates
+            // from its own descriptor allocator. Not to be called from two threads at once
+            std::vector<MaterialInstance> writeMaterials(
+                const std::span<const MetallicRoughness::MaterialRequest> requests
+            );
+
+            // Frees every set written by writeMaterials, no frame in flight may still use them
+            void releaseMaterialDescriptors();
+
+            const MaterialWriteStatistics& getMaterialWriteStatistics() const;
+
+            DescriptorPoolRecycler::RecyclerStatistics getMaterialPoolStatistics() const;
+
+            DescriptorCacheStatistics getDescriptorCacheStatistics() const;
+
+            // Per-frame descriptor pools of the most recently drawn frame
+            DescriptorAllocator::AllocatorStatistics getFrameDescriptorStatistics() const;
+
+            // Packs every mesh at the front of the geometry pool, waits for pending uploads
+            void defragmentGeometry();
+
             bool resizeRequested();
             
             void resizeSwapchain();            
@@ -42,15 +240,49 @@ namespace mdsm::vkei
         private:
             const bool debug;
 
-            static constexpr std::size_t frame_overlap {2};
+            const EngineSettings settings;
+
+            JobSystem job_system;
+
+            static constexpr std::size_t min_frames_in_flight {1};
+            static constexpr std::size_t max_frames_in_flight {4};
+
+            const std::size_t frame_overlap;
 
             bool stop_rendering {};
+            bool frame_ready {};
             bool resize_requested {};
 
             std::size_t frame_number {};
 
+            static constexpr std::size_t readback_pixel_size {8};
+
+            static constexpr std::size_t transient_arena_size {1 << 20};
+
+            static constexpr std::size_t staging_ring_size {64 << 20};
+
+            // Initial geometry pool capacities in elements, the pool doubles when full
+            static constexpr std::uint32_t geometry_pool_vertex_capacity {1 << 20};
+            static constexpr std::uint32_t geometry_pool_index_capacity {1 << 22};
+
+            static constexpr std::size_t max_recording_threads {16};
+
+            // Below this many draws per thread the extra secondaries cost more than they save
+            static constexpr std::size_t min_draws_per_recording_thread {256};
+
+            const std::size_t recording_thread_count;
+
             ResourceCleaner resource_cleaner;
 
+            struct RetiredResource
+            {
+                std::size_t retire_frame;
+
+                std::function<void()> cleaner;
+            };
+
+            std::deque<RetiredResource> retired_resources;
+
             vkb::Instance vkb_instance;
             vkb::PhysicalDevice vkb_physical_device;
             vkb::Device vkb_device;
@@ -62,13 +294,15 @@ namespace mdsm::vkei
             VkInstance instance;
             VkDebugUtilsMessengerEXT debug_messenger;
 
-            VkSurfaceKHR surface;
+            VkSurfaceKHR surface {};
 
             VkPhysicalDevice physical_device;
             VkDevice         logical_device;
     
-            VkSwapchainKHR swapchain;
+            VkSwapchainKHR swapchain {};
             VkFormat swapchain_image_format;
+
+            VkPresentModeKHR present_mode {VK_PRESENT_MODE_FIFO_KHR};
     
             VkExtent2D swapchain_extent;
     
@@ -82,23 +316,83 @@ namespace mdsm::vkei
     
             float render_scale {1.f};
     
-            std::array<FrameData, frame_overlap> frames;
+            std::vector<FrameData> frames;
+
+            RollingStatistics frame_wait_statistics;
+            RollingStatistics present_latency_statistics;
+            RollingStatistics cpu_frame_statistics;
+
+            std::chrono::microseconds target_frame_time;
+
+            std::chrono::steady_clock::time_point last_present_time;
     
             VkQueue graphics_queue;
     
             std::uint32_t graphics_queue_family;
+
+            // Falls back to the graphics queue when no dedicated transfer family exists
+            VkQueue transfer_queue;
+
+            std::uint32_t transfer_queue_family;
             
             VmaAllocator allocator;
     
             VkCommandBuffer immediate_command_buffer;
             VkCommandPool immediate_command_pool;
     
-            VkFence immediate_fence;
+            TimelineSemaphore graphics_timeline;
+
+            GpuProfiler gpu_profiler;
+
+            ImageStateTracker image_states;
+
+            RenderGraph render_graph;
+
+            UploadService upload_service;
+
+            GeometryPool geometry_pool;
+
+            static constexpr std::uint32_t bindless_texture_capacity {4096};
+            static constexpr std::uint32_t bindless_material_capacity {4096};
+
+            BindlessTable bindless_table;
+
+            static constexpr VkDeviceSize frame_descriptor_buffer_size {1 << 16};
+            static constexpr VkDeviceSize material_descriptor_buffer_size {1 << 20};
+
+            // Bound as buffer 0 and 1, holding the frame's sets and the material sets
+            static constexpr std::uint32_t frame_descriptor_buffer_index {0};
+            static constexpr std::uint32_t material_descriptor_buffer_index {1};
+
+            DescriptorBufferFunctions descriptor_buffer_functions {};
+            VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties {};
+
+            DescriptorBuffer material_descriptor_buffer;
+
+            RollingStatistics descriptor_write_statistics;
+            RollingStatistics record_statistics;
+
+            // Filled once per frame, only read while recording so threads can push it concurrently
+            DescriptorWriter scene_descriptor_writer;
     
             DescriptorAllocator global_descriptor_allocator;
-    
-            VkDescriptorSet draw_image_descriptors;
-            VkDescriptorSetLayout draw_image_descriptor_layout;
+
+            // Sets of global_descriptor_allocator are never freed, so neither are its entries
+            DescriptorSetCache global_descriptor_cache;
+
+            // Sets of the material allocators, cleared when they release their pools
+            DescriptorSetCache material_descriptor_cache;
+
+            // Uses of a frame before its descriptor pools and cache are reset
+            static constexpr std::size_t frame_descriptor_cache_lifetime {64};
+
+            // Indexed by job system queue, the pools they release are shared through the recycler
+            std::vector<std::unique_ptr<DescriptorAllocator>> material_descriptor_allocators;
+            DescriptorPoolRecycler material_pool_recycler;
+
+            MaterialWriteStatistics material_write_statistics {};
+
+            static constexpr std::uint32_t material_sets_per_thread {64};
     
             SceneData scene_data;
     
@@ -116,7 +410,73 @@ namespace mdsm::vkei
 
             std::vector<std::shared_ptr<MeshAsset>> test_meshes;
 
-            std::unordered_map<std::string_view, std::shared_ptr<Node>> loaded_nodes;
+            std::unordered_map<std::string, std::shared_ptr<Node>> loaded_nodes;
+
+            static constexpr std::size_t nodes_per_traversal_job {16};
+
+            // Reused every frame, one per traversal job
+            std::vector<Node*> traversal_roots;
+            std::vector<DrawContext> traversal_contexts;
+
+            // Sort key fields, from most to least significant
+            static constexpr std::uint64_t sort_pipeline_bits {8};
+            static constexpr std::uint64_t sort_material_bits {20};
+            static constexpr std::uint64_t sort_geometry_bits {20};
+            static constexpr std::uint64_t sort_depth_bits {16};
+
+            // Reused every frame, ids are dense per frame and only order the keys
+            std::unordered_map<VkPipeline, std::uint64_t> pipeline_sort_ids;
+            // Keyed by descriptor set, or by descriptor offset with descriptor buffers
+            std::unordered_map<std::uint64_t, std::uint64_t> material_sort_ids;
+
+            // Keyed by first index and vertex offset
+            std::unordered_map<std::uint64_t, std::uint64_t> geometry_sort_ids;
+
+            FrustumCuller frustum_culler;
+            FrustumCuller transparent_culler;
+
+            // Indices into the draw list being sorted that survived culling
+            std::vector<std::uint32_t> visible_surfaces;
+
+            std::vector<SortItem> draw_order;
+            std::vector<SortItem> draw_order_scratch;
+
+            // Back to front, indices into main_draw_context.transparent_surfaces
+            std::vector<SortItem> transparent_order;
+
+            // Consecutive sorted objects drawing the same surface with the same material
+            struct InstanceGroup
+            {
+                const RenderObject* object;
+
+                std::uint32_t first_instance;
+                std::uint32_t instance_count;
+            };
+
+            static constexpr std::size_t min_instance_capacity {1024};
+
+            // Transforms copied per job when filling the instance buffer
+            static constexpr std::size_t instances_per_copy_job {4096};
+
+            std::vector<InstanceGroup> instance_groups;
+
+            // Instances follow the opaque ones in the instance buffer
+            std::vector<InstanceGroup> transparent_groups;
+
+            // One per recording chunk, summed into draw_statistics
+            std::vector<DrawStatistics> recording_statistics;
+
+            DrawStatistics draw_statistics {};
+
+            // Initial object buffer of the GPU-driven path
+            static constexpr std::uint32_t min_gpu_object_capacity {1024};
+            static constexpr std::size_t min_gpu_batch_capacity {64};
+
+            GpuCuller gpu_culler;
+
+            GpuScene gpu_scene;
+
+            bool gpu_scene_dirty {true};
 
             void initializeWindow(const std::size_t width,
                 const std::size_t height,
@@ -126,18 +486,42 @@ namespace mdsm::vkei
             void initializePhysicalDevice();
             void initializeLogicalDevice();
             void initializeAllocator();
-            void createSwapchain(const std::size_t width, const std::size_t height);
+            void createSwapchain(
+                const std::size_t width,
+                const std::size_t height,
+                const VkSwapchainKHR old_swapchain = VK_NULL_HANDLE
+            );
+            void createRenderTargets(const VkExtent2D extent);
+            VkPresentModeKHR selectPresentMode(const PresentModePolicy policy) const;
             void initializeSwapchain();
+            void initializeReadbackBuffers();
+            void initializeQueries();
+            void initializeTransientArenas();
+            void initializeGpuCulling();
+            void initializeInstanceBuffers();
             void initializeQueues();
             void initializeCommands();
             void initializeSyncStructures();
+            void initializeUploadService();
+            void initializeGeometryPool();
             void initializeDescriptors();
+            void initializeBindlessTable();
+            void initializeDescriptorBuffers();
             void initializePipelines();
             void initializeDefaultData();
     
             void destroySwapchain();
 
+            void retireResource(std::function<void()>&& cleaner);
+            void destroyRetiredResources(const bool force = false);
+
+            void submitHeadless(const VkCommandBuffer command_buffer);
+
+            void waitForFrame(const FrameData& frame);
+
             void updateScene();
+
+            void traverseScene(const glm::mat4& top_matrix);
     
             AllocatedBuffer createBuffer(
                 const std::size_t allocate_size,
@@ -151,9 +535,11 @@ namespace mdsm::vkei
                 const std::function<void(const VkCommandBuffer command_buffer)>&& function
             );
     
+            // Also computes the bounds of each surface from its index range
             MeshBuffers uploadMesh(
                 const std::span<std::uint32_t> indices,
-                const std::span<Vertex> vertices
+                const std::span<Vertex> vertices,
+                const std::span<Surface> surfaces
             );
     
             AllocatedImage createImage(
@@ -172,9 +558,78 @@ namespace mdsm::vkei
             );
     
             void destroyImage(const AllocatedImage& image);
+
+            // Old pool buffers are retired until the frames in flight are done with them
+            void relocateGeometry(const std::uint32_t vertex_capacity, const std::uint32_t index_capacity);
     
             void drawBackground(const VkCommandBuffer command_buffer);
             void drawGeometry(const VkCommandBuffer command_buffer);
+
+            // Dense ids of the bind state, the sort id maps must be cleared first
+            std::uint64_t getStateSortKey(const RenderObject& object);
+
+            // Fills draw_order with the visible ready opaque surfaces, sorted by state, surface and depth
+            void sortDrawOrder();
+
+            // Fills transparent_order with the visible ready transparent surfaces, farthest first
+            void sortTransparentOrder();
+
+            // Writes the sorted opaque and transparent transforms into the frame's instance buffer
+            // and groups repeated surfaces
+            void buildInstanceGroups(const std::span<const SortItem> opaque_order);
+
+            void appendInstanceGroups(
+                const std::span<const RenderObject> objects,
+                const std::span<const SortItem> order,
+                const std::uint32_t first_instance,
+                std::vector<InstanceGroup>& groups
+            );
+
+            void reserveInstanceBuffer(FrameData& frame, const std::size_t instance_count);
+
+            // Diffs the opaque surfaces into the GPU scene when it is dirty, then promotes finished uploads
+            void syncGpuScene();
+
+            void reserveGpuScene(FrameData& frame, const std::size_t command_count, const std::size_t batch_count);
+
+            void addGeometryPasses(
+                const RenderGraph::ResourceHandle draw_target,
+                const RenderGraph::ResourceHandle depth_target
+            );
+
+            DescriptorBinding writeSceneDescriptor();
+
+            // Descriptor buffer bindings are not inherited, every command buffer binds them itself
+            void bindDescriptorBuffers(const VkCommandBuffer command_buffer);
+
+            void bindDescriptor(
+                const VkCommandBuffer command_buffer,
+                const VkPipelineLayout layout,
+                const std::uint32_t set_index,
+                const DescriptorBinding& descriptor
+            );
+
+            void setViewportAndScissor(const VkCommandBuffer command_buffer);
+
+            void drawGeometryIndirect(const VkCommandBuffer command_buffer);
+
+            VkDeviceAddress getBufferDeviceAddress(const VkBuffer buffer) const;
+
+            // Records a secondary command buffer inside the geometry rendering
+            void recordGeometry(
+                const VkCommandBuffer command_buffer,
+                const std::span<const InstanceGroup> groups,
+                const DescriptorBinding& global_descriptor,
+                DrawStatistics& statistics
+            );
+
+            // Expects the pool index buffer to be bound already
+            void recordDraws(
+                const VkCommandBuffer command_buffer,
+                const std::span<const InstanceGroup> groups,
+                const DescriptorBinding& global_descriptor,
+                DrawStatistics& statistics
+            );
     
             void cleanup();
     
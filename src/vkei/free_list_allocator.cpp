@@ -0,0 +1,129 @@
+#include "free_list_allocator.hpp"
+
+#include <iterator>
+
+namespace mdsm::vkei
+{
+    void FreeListAllocator::initialize(const std::uint64_t capacity)
+    {
+        this->capacity = capacity;
+
+        used = 0;
+
+        free_blocks.clear();
+        blocks_by_size.clear();
+
+        if(capacity != 0)
+        {
+            insertBlock(0, capacity);
+        }
+    }
+
+    std::optional<std::uint64_t> FreeListAllocator::allocate(const std::uint64_t size)
+    {
+        if(size == 0)
+        {
+            return 0;
+        }
+
+        const auto best_fit {blocks_by_size.lower_bound(size)};
+
+        if(best_fit == blocks_by_size.end())
+        {
+            return std::nullopt;
+        }
+
+        const std::uint64_t offset {best_fit->second};
+        const std::uint64_t block_size {best_fit->first};
+
+        eraseBlock(free_blocks.find(offset));
+
+        if(block_size > size)
+        {
+            insertBlock(offset + size, block_size - size);
+        }
+
+        used += size;
+
+        return offset;
+    }
+
+    void FreeListAllocator::free(std::uint64_t offset, std::uint64_t size)
+    {
+        if(size == 0)
+        {
+            return;
+        }
+
+        used -= size;
+
+        const auto next {free_blocks.lower_bound(offset)};
+
+        if(next != free_blocks.end() && offset + size == next->first)
+        {
+            size += next->second;
+
+            eraseBlock(next);
+        }
+
+        const auto previous {free_blocks.lower_bound(offset)};
+
+        if(previous != free_blocks.begin())
+        {
+            const auto before {std::prev(previous)};
+
+            if(before->first + before->second == offset)
+            {
+                offset = before->first;
+                size += before->second;
+
+                eraseBlock(before);
+            }
+        }
+
+        insertBlock(offset, size);
+    }
+
+    std::uint64_t FreeListAllocator::getCapacity() const
+    {
+        return capacity;
+    }
+
+    std::uint64_t FreeListAllocator::getUsedSize() const
+    {
+        return used;
+    }
+
+    std::uint64_t FreeListAllocator::getLargestFreeBlock() const
+    {
+        return blocks_by_size.empty()? 0 : blocks_by_size.rbegin()->first;
+    }
+
+    std::size_t FreeListAllocator::getFreeBlockCount() const
+    {
+        return free_blocks.size();
+    }
+
+    void FreeListAllocator::insertBlock(const std::uint64_t offset, const std::uint64_t size)
+    {
+        free_blocks.emplace(offset, size);
+        blocks_by_size.emplace(size, offset);
+    }
+
+    void FreeListAllocator::eraseBlock(const std::map<std::uint64_t, std::uint64_t>::iterator block)
+    {
+        auto [first, last] {blocks_by_size.equal_range(block->second)};
+
+        for(; first != last; ++first)
+        {
+            if(first->second == block->first)
+            {
+                blocks_by_size.erase(first);
+
+                break;
+            }
+        }
+
+        free_blocks.erase(block);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace mdsm::vkei
+{
+    // Best-fit range allocator over [0, capacity), freed ranges are coalesced with their neighbours
+    class FreeListAllocator
+    {
+        public:
+            FreeListAllocator() = default;
+
+            FreeListAllocator(const FreeListAllocator&) = delete;
+            FreeListAllocator& operator=(const FreeListAllocator&) = delete;
+
+            // Drops every allocation
+            void initialize(const std::uint64_t capacity);
+
+            // Returns nothing if no free range is large enough
+            std::optional<std::uint64_t> allocate(const std::uint64_t size);
+
+            void free(const std::uint64_t offset, const std::uint64_t size);
+
+            std::uint64_t getCapacity() const;
+            std::uint64_t getUsedSize() const;
+            std::uint64_t getLargestFreeBlock() const;
+
+            std::size_t getFreeBlockCount() const;
+
+        private:
+            std::uint64_t capacity {};
+            std::uint64_t used {};
+
+            // Offset to size, and the same blocks ordered by size for the best-fit search
+            std::map<std::uint64_t, std::uint64_t> free_blocks;
+            std::multimap<std::uint64_t, std::uint64_t> blocks_by_size;
+
+            void insertBlock(const std::uint64_t offset, const std::uint64_t size);
+            void eraseBlock(const std::map<std::uint64_t, std::uint64_t>::iterator block);
+    };
+}
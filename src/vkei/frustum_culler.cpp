@@ -0,0 +1,203 @@
+#include "frustum_culler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+namespace mdsm::vkei
+{
+    Bounds computeBounds(const std::span<const std::uint32_t> indices, const std::span<const Vertex> vertices)
+    {
+        if(indices.empty())
+        {
+            return {};
+        }
+
+        glm::vec3 min_position {std::numeric_limits<float>::max()};
+        glm::vec3 max_position {std::numeric_limits<float>::lowest()};
+
+        for(const auto index : indices)
+        {
+            min_position = glm::min(min_position, vertices[index].position);
+            max_position = glm::max(max_position, vertices[index].position);
+        }
+
+        Bounds bounds;
+
+        bounds.origin = (max_position + min_position) / 2.f;
+        bounds.extents = (max_position - min_position) / 2.f;
+        bounds.sphere_radius = glm::length(bounds.extents);
+
+        return bounds;
+    }
+
+    std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& view_proj)
+    {
+        const glm::mat4 rows {glm::transpose(view_proj)};
+
+        // Clip space is -w <= x, y <= w and 0 <= z <= w
+        std::array<glm::vec4, 6> planes {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            rows[2],
+            rows[3] - rows[2]
+        };
+
+        for(auto& plane : planes)
+        {
+            plane /= glm::length(glm::vec3{plane});
+        }
+
+        return planes;
+    }
+
+    void FrustumCuller::cull(
+        const glm::mat4& view_proj,
+        const std::span<const RenderObject> objects,
+        std::vector<std::uint32_t>& visible
+    )
+    {
+        const auto cull_start {std::chrono::steady_clock::now()};
+
+        planes = extractFrustumPlanes(view_proj);
+        gatherSpheres(objects);
+
+        visible.clear();
+
+        testSpheres(objects.size(), visible);
+
+        statistics.visible_count = visible.size();
+        statistics.culled_count = objects.size() - visible.size();
+        statistics.cull_time = std::chrono::steady_clock::now() - cull_start;
+    }
+
+    const FrustumCuller::CullStatistics& FrustumCuller::getStatistics() const
+    {
+        return statistics;
+    }
+
+    void FrustumCuller::gatherSpheres(const std::span<const RenderObject> objects)
+    {
+        const std::size_t padded_count {(objects.size() + lane_count - 1) / lane_count * lane_count};
+
+        centers_x.resize(padded_count);
+        centers_y.resize(padded_count);
+        centers_z.resize(padded_count);
+        radii.resize(padded_count);
+
+        for(std::size_t object {}; object < objects.size(); ++object)
+        {
+            const glm::mat4& transform {objects[object].transform};
+            const Bounds& bounds {objects[object].bounds};
+
+            const glm::vec4 center {transform * glm::vec4{bounds.origin, 1.f}};
+
+            const float max_scale_squared {
+                std::max(
+                    {
+                        glm::dot(glm::vec3{transform[0]}, glm::vec3{transform[0]}),
+                        glm::dot(glm::vec3{transform[1]}, glm::vec3{transform[1]}),
+                        glm::dot(glm::vec3{transform[2]}, glm::vec3{transform[2]})
+                    }
+                )
+            };
+
+            centers_x[object] = center.x;
+            centers_y[object] = center.y;
+            centers_z[object] = center.z;
+            radii[object] = bounds.sphere_radius * std::sqrt(max_scale_squared);
+        }
+    }
+
+    void FrustumCuller::testSpheres(const std::size_t count, std::vector<std::uint32_t>& visible) const
+    {
+        const auto appendVisible {
+            [&](const std::size_t first, std::uint32_t mask)
+            {
+                for(; mask; mask &= mask - 1)
+                {
+                    const std::size_t object {first + std::countr_zero(mask)};
+
+                    // Padding lanes hold stale spheres
+                    if(object < count)
+                    {
+                        visible.push_back(static_cast<std::uint32_t>(object));
+                    }
+                }
+            }
+        };
+
+#if defined(__AVX__)
+        for(std::size_t first {}; first < count; first += 8)
+        {
+            const __m256 x {_mm256_loadu_ps(&centers_x[first])};
+            const __m256 y {_mm256_loadu_ps(&centers_y[first])};
+            const __m256 z {_mm256_loadu_ps(&centers_z[first])};
+            const __m256 negative_radius {_mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radii[first]))};
+
+            __m256 inside {_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+
+            for(const auto& plane : planes)
+            {
+                __m256 distance {_mm256_mul_ps(x, _mm256_set1_ps(plane.x))};
+
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(plane.y)));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(plane.z)));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+            }
+
+            appendVisible(first, static_cast<std::uint32_t>(_mm256_movemask_ps(inside)));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for(std::size_t first {}; first < count; first += 4)
+        {
+            const __m128 x {_mm_loadu_ps(&centers_x[first])};
+            const __m128 y {_mm_loadu_ps(&centers_y[first])};
+            const __m128 z {_mm_loadu_ps(&centers_z[first])};
+            const __m128 negative_radius {_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radii[first]))};
+
+            __m128 inside {_mm_castsi128_ps(_mm_set1_epi32(-1))};
+
+            for(const auto& plane : planes)
+            {
+                __m128 distance {_mm_mul_ps(x, _mm_set1_ps(plane.x))};
+
+                distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+                distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+            }
+
+            appendVisible(first, static_cast<std::uint32_t>(_mm_movemask_ps(inside)));
+        }
+#else
+        for(std::size_t object {}; object < count; ++object)
+        {
+            const bool inside {
+                std::ranges::all_of(
+                    planes,
+                    [&](const glm::vec4& plane)
+                    {
+                        return plane.x * centers_x[object]
+                            + plane.y * centers_y[object]
+                            + plane.z * centers_z[object]
+                            + plane.w >= -radii[object];
+                    }
+                )
+            };
+
+            appendVisible(object, inside);
+        }
+#endif
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace mdsm::vkei
+{
+    // Bounds of the vertices referenced by indices
+    Bounds computeBounds(const std::span<const std::uint32_t> indices, const std::span<const Vertex> vertices);
+
+    // Normalized planes facing inwards, a point is inside when dot(plane.xyz, point) + plane.w >= 0
+    std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& view_proj);
+
+    class FrustumCuller
+    {
+        public:
+            struct CullStatistics
+            {
+                std::size_t visible_count;
+                std::size_t culled_count;
+
+                std::chrono::nanoseconds cull_time;
+            };
+
+            FrustumCuller() = default;
+
+            FrustumCuller(const FrustumCuller&) = delete;
+            FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+            // Writes the indices of the objects whose bounding sphere touches the frustum, in object order
+            void cull(
+                const glm::mat4& view_proj,
+                const std::span<const RenderObject> objects,
+                std::vector<std::uint32_t>& visible
+            );
+
+            const CullStatistics& getStatistics() const;
+
+        private:
+            // Objects tested per kernel iteration, the sphere arrays are padded to it
+            static constexpr std::size_t lane_count {8};
+
+            std::array<glm::vec4, 6> planes {};
+
+            // World-space spheres, one array per component
+            std::vector<float> centers_x;
+            std::vector<float> centers_y;
+            std::vector<float> centers_z;
+            std::vector<float> radii;
+
+            CullStatistics statistics {};
+
+            void gatherSpheres(const std::span<const RenderObject> objects);
+
+            void testSpheres(const std::size_t count, std::vector<std::uint32_t>& visible) const;
+    };
+}
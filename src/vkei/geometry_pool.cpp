@@ -0,0 +1,322 @@
+#include "geometry_pool.hpp"
+#include "utils.hpp"
+
+#include <array>
+
+namespace mdsm::vkei
+{
+    void GeometryPool::initialize(
+        const VkDevice device,
+        const VmaAllocator allocator,
+        UploadService& upload_service,
+        const std::uint32_t vertex_capacity,
+        const std::uint32_t index_capacity
+    )
+    {
+        this->device = device;
+        this->allocator = allocator;
+        this->upload_service = &upload_service;
+
+        createBuffers(vertex_capacity, index_capacity);
+
+        vertex_allocator.initialize(vertex_capacity);
+        index_allocator.initialize(index_capacity);
+    }
+
+    void GeometryPool::destroy()
+    {
+        destroyBuffers(buffers);
+
+        ranges.clear();
+        live_ranges.clear();
+        free_handles.clear();
+    }
+
+    std::optional<GeometryPool::Handle> GeometryPool::allocate(
+        const std::uint32_t vertex_count,
+        const std::uint32_t index_count
+    )
+    {
+        const auto first_vertex {vertex_allocator.allocate(vertex_count)};
+
+        if(!first_vertex)
+        {
+            return std::nullopt;
+        }
+
+        const auto first_index {index_allocator.allocate(index_count)};
+
+        if(!first_index)
+        {
+            vertex_allocator.free(*first_vertex, vertex_count);
+
+            return std::nullopt;
+        }
+
+        const Range range {
+            .first_vertex = static_cast<std::uint32_t>(*first_vertex),
+            .vertex_count = vertex_count,
+            .first_index = static_cast<std::uint32_t>(*first_index),
+            .index_count = index_count
+        };
+
+        if(free_handles.empty())
+        {
+            ranges.push_back(range);
+            live_ranges.push_back(true);
+
+            return static_cast<Handle>(ranges.size() - 1);
+        }
+
+        const Handle handle {free_handles.back()};
+
+        free_handles.pop_back();
+
+        ranges[handle] = range;
+        live_ranges[handle] = true;
+
+        return handle;
+    }
+
+    void GeometryPool::free(const Handle handle)
+    {
+        const Range& range {ranges[handle]};
+
+        vertex_allocator.free(range.first_vertex, range.vertex_count);
+        index_allocator.free(range.first_index, range.index_count);
+
+        live_ranges[handle] = false;
+
+        free_handles.push_back(handle);
+    }
+
+    std::uint64_t GeometryPool::upload(
+        const Handle handle,
+        const std::span<const std::uint32_t> indices,
+        const std::span<const Vertex> vertices
+    )
+    {
+        const Range& range {ranges[handle]};
+
+        const std::array<UploadService::BufferUpload, 2> uploads {
+            UploadService::BufferUpload{
+                .destination = buffers.vertex_buffer,
+                .destination_offset = range.first_vertex * sizeof(Vertex),
+                .data = vertices.data(),
+                .size = vertices.size_bytes()
+            },
+            UploadService::BufferUpload{
+                .destination = buffers.index_buffer,
+                .destination_offset = range.first_index * sizeof(std::uint32_t),
+                .data = indices.data(),
+                .size = indices.size_bytes()
+            }
+        };
+
+        return upload_service->uploadBuffers(uploads);
+    }
+
+    bool GeometryPool::fitsAfterCompaction(
+        const std::uint32_t vertex_count,
+        const std::uint32_t index_count
+    ) const
+    {
+        return vertex_allocator.getUsedSize() + vertex_count <= vertex_allocator.getCapacity()
+            && index_allocator.getUsedSize() + index_count <= index_allocator.getCapacity();
+    }
+
+    GeometryPool::Buffers GeometryPool::relocate(
+        const VkCommandBuffer command_buffer,
+        const std::uint32_t vertex_capacity,
+        const std::uint32_t index_capacity
+    )
+    {
+        const Buffers old_buffers {buffers};
+
+        createBuffers(vertex_capacity, index_capacity);
+
+        vertex_allocator.initialize(vertex_capacity);
+        index_allocator.initialize(index_capacity);
+
+        std::vector<VkBufferCopy> vertex_copies;
+        std::vector<VkBufferCopy> index_copies;
+
+        for(Handle handle {}; handle < ranges.size(); ++handle)
+        {
+            if(!live_ranges[handle])
+            {
+                continue;
+            }
+
+            Range& range {ranges[handle]};
+
+            // The new allocators are empty, so ranges are packed in handle order
+            const std::uint64_t first_vertex {*vertex_allocator.allocate(range.vertex_count)};
+            const std::uint64_t first_index {*index_allocator.allocate(range.index_count)};
+
+            if(range.vertex_count != 0)
+            {
+                vertex_copies.push_back(
+                    VkBufferCopy{
+                        .srcOffset = range.first_vertex * sizeof(Vertex),
+                        .dstOffset = first_vertex * sizeof(Vertex),
+                        .size = range.vertex_count * sizeof(Vertex)
+                    }
+                );
+            }
+
+            if(range.index_count != 0)
+            {
+                index_copies.push_back(
+                    VkBufferCopy{
+                        .srcOffset = range.first_index * sizeof(std::uint32_t),
+                        .dstOffset = first_index * sizeof(std::uint32_t),
+                        .size = range.index_count * sizeof(std::uint32_t)
+                    }
+                );
+            }
+
+            range.first_vertex = static_cast<std::uint32_t>(first_vertex);
+            range.first_index = static_cast<std::uint32_t>(first_index);
+        }
+
+        if(!vertex_copies.empty())
+        {
+            vkCmdCopyBuffer(
+                command_buffer,
+                old_buffers.vertex_buffer,
+                buffers.vertex_buffer,
+                static_cast<std::uint32_t>(vertex_copies.size()),
+                vertex_copies.data()
+            );
+        }
+
+        if(!index_copies.empty())
+        {
+            vkCmdCopyBuffer(
+                command_buffer,
+                old_buffers.index_buffer,
+                buffers.index_buffer,
+                static_cast<std::uint32_t>(index_copies.size()),
+                index_copies.data()
+            );
+        }
+
+        VkMemoryBarrier2 barrier {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .pNext = nullptr
+        };
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+
+        VkDependencyInfo dependency_info {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr
+        };
+
+        dependency_info.memoryBarrierCount = 1;
+        dependency_info.pMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+
+        ++relocation_count;
+
+        return old_buffers;
+    }
+
+    void GeometryPool::destroyBuffers(const Buffers& pool_buffers)
+    {
+        vmaDestroyBuffer(allocator, pool_buffers.vertex_buffer, pool_buffers.vertex_allocation);
+        vmaDestroyBuffer(allocator, pool_buffers.index_buffer, pool_buffers.index_allocation);
+    }
+
+    const GeometryPool::Range& GeometryPool::getRange(const Handle handle) const
+    {
+        return ranges[handle];
+    }
+
+    VkBuffer GeometryPool::getIndexBuffer() const
+    {
+        return buffers.index_buffer;
+    }
+
+    VkDeviceAddress GeometryPool::getVertexBufferAddress() const
+    {
+        return vertex_buffer_address;
+    }
+
+    GeometryPool::PoolStatistics GeometryPool::getStatistics() const
+    {
+        return PoolStatistics{
+            .vertex_capacity = vertex_allocator.getCapacity(),
+            .used_vertices = vertex_allocator.getUsedSize(),
+            .index_capacity = index_allocator.getCapacity(),
+            .used_indices = index_allocator.getUsedSize(),
+            .free_block_count = vertex_allocator.getFreeBlockCount() + index_allocator.getFreeBlockCount(),
+            .relocation_count = relocation_count
+        };
+    }
+
+    void GeometryPool::createBuffers(const std::uint32_t vertex_capacity, const std::uint32_t index_capacity)
+    {
+        VmaAllocationCreateInfo allocation_info {};
+
+        allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        VkBufferCreateInfo vertex_buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        vertex_buffer_info.size = vertex_capacity * sizeof(Vertex);
+        vertex_buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &vertex_buffer_info,
+                &allocation_info,
+                &buffers.vertex_buffer,
+                &buffers.vertex_allocation,
+                nullptr
+            )
+        );
+
+        VkBufferCreateInfo index_buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        index_buffer_info.size = index_capacity * sizeof(std::uint32_t);
+        index_buffer_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+            | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &index_buffer_info,
+                &allocation_info,
+                &buffers.index_buffer,
+                &buffers.index_allocation,
+                nullptr
+            )
+        );
+
+        VkBufferDeviceAddressInfo device_address_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr
+        };
+
+        device_address_info.buffer = buffers.vertex_buffer;
+
+        vertex_buffer_address = vkGetBufferDeviceAddress(device, &device_address_info);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "free_list_allocator.hpp"
+#include "types.hpp"
+#include "upload_service.hpp"
+#include "vk_mem_alloc.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Suballocates vertex and index ranges of every mesh out of one shared vertex buffer
+    // and one shared index buffer. Indices stay relative to their mesh's first vertex
+    class GeometryPool
+    {
+        public:
+            using Handle = std::uint32_t;
+
+            struct Range
+            {
+                std::uint32_t first_vertex;
+                std::uint32_t vertex_count;
+
+                std::uint32_t first_index;
+                std::uint32_t index_count;
+            };
+
+            struct Buffers
+            {
+                VkBuffer vertex_buffer;
+                VmaAllocation vertex_allocation;
+
+                VkBuffer index_buffer;
+                VmaAllocation index_allocation;
+            };
+
+            struct PoolStatistics
+            {
+                std::uint64_t vertex_capacity;
+                std::uint64_t used_vertices;
+
+                std::uint64_t index_capacity;
+                std::uint64_t used_indices;
+
+                std::size_t free_block_count;
+
+                std::size_t relocation_count;
+            };
+
+            GeometryPool() = default;
+
+            GeometryPool(const GeometryPool&) = delete;
+            GeometryPool& operator=(const GeometryPool&) = delete;
+
+            void initialize(
+                const VkDevice device,
+                const VmaAllocator allocator,
+                UploadService& upload_service,
+                const std::uint32_t vertex_capacity,
+                const std::uint32_t index_capacity
+            );
+
+            void destroy();
+
+            // Returns nothing if either range does not fit, relocate first
+            std::optional<Handle> allocate(const std::uint32_t vertex_count, const std::uint32_t index_count);
+
+            void free(const Handle handle);
+
+            // Returns the upload ticket
+            std::uint64_t upload(
+                const Handle handle,
+                const std::span<const std::uint32_t> indices,
+                const std::span<const Vertex> vertices
+            );
+
+            // True if the ranges would fit once the pool is compacted
+            bool fitsAfterCompaction(const std::uint32_t vertex_count, const std::uint32_t index_count) const;
+
+            // Records copies that pack every live range at the front of new buffers with the given
+            // capacities. The returned old buffers must outlive the copy and every draw still using them
+            Buffers relocate(
+                const VkCommandBuffer command_buffer,
+                const std::uint32_t vertex_capacity,
+                const std::uint32_t index_capacity
+            );
+
+            void destroyBuffers(const Buffers& pool_buffers);
+
+            const Range& getRange(const Handle handle) const;
+
+            VkBuffer getIndexBuffer() const;
+            VkDeviceAddress getVertexBufferAddress() const;
+
+            PoolStatistics getStatistics() const;
+
+        private:
+            VkDevice device {};
+            VmaAllocator allocator {};
+
+            UploadService* upload_service {};
+
+            Buffers buffers {};
+
+            VkDeviceAddress vertex_buffer_address {};
+
+            FreeListAllocator vertex_allocator;
+            FreeListAllocator index_allocator;
+
+            std::vector<Range> ranges;
+            std::vector<bool> live_ranges;
+
+            std::vector<Handle> free_handles;
+
+            std::size_t relocation_count {};
+
+            void createBuffers(const std::uint32_t vertex_capacity, const std::uint32_t index_capacity);
+    };
+}
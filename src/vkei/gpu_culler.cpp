@@ -0,0 +1,104 @@
+#include "gpu_culler.hpp"
+#include "frustum_culler.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+
+namespace mdsm::vkei
+{
+    GpuCuller::GpuCuller()
+    :
+        shader {VK_SHADER_STAGE_COMPUTE_BIT}
+    {
+    }
+
+    void GpuCuller::initialize(const VkDevice device, const std::filesystem::path shader_path)
+    {
+        shader.setPath(shader_path);
+        shader.compile(device);
+
+        VkPushConstantRange push_constant_range {};
+
+        push_constant_range.offset = 0;
+        push_constant_range.size = sizeof(CullPushConstants);
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkPipelineLayoutCreateInfo layout_info {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        layout_info.pushConstantRangeCount = 1;
+        layout_info.pPushConstantRanges = &push_constant_range;
+
+        check(
+            vkCreatePipelineLayout(device, &layout_info, nullptr, &layout)
+        );
+
+        VkPipelineShaderStageCreateInfo stage_info {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        stage_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage_info.module = shader;
+        stage_info.pName = "main";
+
+        VkComputePipelineCreateInfo pipeline_info {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        pipeline_info.stage = stage_info;
+        pipeline_info.layout = layout;
+
+        check(
+            vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline)
+        );
+
+        shader.destroy(device);
+    }
+
+    void GpuCuller::destroy(const VkDevice device)
+    {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    }
+
+    void GpuCuller::record(
+        const VkCommandBuffer command_buffer,
+        const glm::mat4& view_proj,
+        const VkDeviceAddress objects,
+        const VkDeviceAddress commands,
+        const VkDeviceAddress counts,
+        const std::uint32_t object_count
+    )
+    {
+        if(object_count == 0)
+        {
+            return;
+        }
+
+        CullPushConstants push_constants {};
+
+        std::ranges::copy(extractFrustumPlanes(view_proj), push_constants.planes);
+
+        push_constants.objects = objects;
+        push_constants.commands = commands;
+        push_constants.counts = counts;
+        push_constants.object_count = object_count;
+
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+        vkCmdPushConstants(
+            command_buffer,
+            layout,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(CullPushConstants),
+            &push_constants
+        );
+
+        vkCmdDispatch(command_buffer, (object_count + group_size - 1) / group_size, 1, 1);
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "shader.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Matches Object in cull.comp and mesh_indirect.vert (std430)
+    struct GpuObject
+    {
+        glm::mat4 transform;
+
+        // Object-space sphere, xyz is the center and w the radius
+        glm::vec4 sphere;
+
+        std::uint32_t first_index;
+        std::uint32_t index_count;
+
+        // Count slot of the object's draw batch and the batch's first command
+        std::uint32_t batch;
+        std::uint32_t command_offset;
+
+        VkDeviceAddress vertex_buffer;
+
+        // Added to every index, the first vertex of the object's range in the geometry pool
+        std::int32_t vertex_offset;
+
+        // Entry in the bindless table, read by the bindless indirect vertex shader
+        std::uint32_t material_index;
+    };
+
+    static_assert(sizeof(GpuObject) == 112);
+
+    // Frustum culls GpuObjects in a compute pass and appends a VkDrawIndexedIndirectCommand
+    // for each visible one to its batch, with firstInstance set to the object index
+    class GpuCuller
+    {
+        public:
+            GpuCuller();
+
+            GpuCuller(const GpuCuller&) = delete;
+            GpuCuller& operator=(const GpuCuller&) = delete;
+
+            void initialize(const VkDevice device, const std::filesystem::path shader_path);
+
+            void destroy(const VkDevice device);
+
+            // Batch counts must already be zeroed
+            void record(
+                const VkCommandBuffer command_buffer,
+                const glm::mat4& view_proj,
+                const VkDeviceAddress objects,
+                const VkDeviceAddress commands,
+                const VkDeviceAddress counts,
+                const std::uint32_t object_count
+            );
+
+        private:
+            static constexpr std::uint32_t group_size {64};
+
+            struct CullPushConstants
+            {
+                glm::vec4 planes[6];
+
+                VkDeviceAddress objects;
+                VkDeviceAddress commands;
+                VkDeviceAddress counts;
+
+                std::uint32_t object_count;
+            };
+
+            static_assert(sizeof(CullPushConstants) <= 128);
+
+            Shader shader;
+
+            VkPipelineLayout layout {};
+            VkPipeline pipeline {};
+    };
+}
@@ -0,0 +1,190 @@
+#include "gpu_profiler.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    void GpuProfiler::initialize(
+        const VkPhysicalDevice physical_device,
+        const std::uint32_t queue_family
+    )
+    {
+        VkPhysicalDeviceProperties properties;
+
+        vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+        std::uint32_t family_count {};
+
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+
+        std::vector<VkQueueFamilyProperties> families (family_count);
+
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+        const std::uint32_t valid_bits {families[queue_family].timestampValidBits};
+
+        enabled = valid_bits != 0 && properties.limits.timestampComputeAndGraphics;
+
+        timestamp_period = properties.limits.timestampPeriod;
+
+        timestamp_mask = valid_bits >= 64? ~std::uint64_t{} : (std::uint64_t{1} << valid_bits) - 1;
+    }
+
+    void GpuProfiler::createQueryPool(const VkDevice device, FrameTimestamps& timestamps)
+    {
+        if(!enabled)
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo pool_info {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        pool_info.queryCount = max_passes_per_frame * 2;
+
+        check(
+            vkCreateQueryPool(device, &pool_info, nullptr, &timestamps.query_pool)
+        );
+
+        timestamps.passes.reserve(max_passes_per_frame);
+    }
+
+    void GpuProfiler::destroyQueryPool(const VkDevice device, FrameTimestamps& timestamps)
+    {
+        if(timestamps.query_pool)
+        {
+            vkDestroyQueryPool(device, timestamps.query_pool, nullptr);
+        }
+
+        timestamps.query_pool = VK_NULL_HANDLE;
+        timestamps.passes.clear();
+    }
+
+    void GpuProfiler::reset(const VkCommandBuffer command_buffer, FrameTimestamps& timestamps)
+    {
+        timestamps.passes.clear();
+        timestamps.pass_open = false;
+
+        if(!enabled)
+        {
+            return;
+        }
+
+        vkCmdResetQueryPool(command_buffer, timestamps.query_pool, 0, max_passes_per_frame * 2);
+    }
+
+    void GpuProfiler::beginPass(
+        const VkCommandBuffer command_buffer,
+        FrameTimestamps& timestamps,
+        const std::string_view pass_name
+    )
+    {
+        if(!enabled || timestamps.pass_open || timestamps.passes.size() == max_passes_per_frame)
+        {
+            return;
+        }
+
+        vkCmdWriteTimestamp2(
+            command_buffer,
+            VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            timestamps.query_pool,
+            static_cast<std::uint32_t>(timestamps.passes.size() * 2)
+        );
+
+        timestamps.passes.push_back(pass_name);
+        timestamps.pass_open = true;
+    }
+
+    void GpuProfiler::endPass(const VkCommandBuffer command_buffer, FrameTimestamps& timestamps)
+    {
+        if(!timestamps.pass_open)
+        {
+            return;
+        }
+
+        vkCmdWriteTimestamp2(
+            command_buffer,
+            VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            timestamps.query_pool,
+            static_cast<std::uint32_t>(timestamps.passes.size() * 2 - 1)
+        );
+
+        timestamps.pass_open = false;
+    }
+
+    void GpuProfiler::collect(const VkDevice device, FrameTimestamps& timestamps)
+    {
+        if(!enabled || timestamps.passes.empty())
+        {
+            return;
+        }
+
+        // Every query is followed by its availability word
+        std::array<std::uint64_t, max_passes_per_frame * 4> results {};
+
+        const auto query_count {
+            static_cast<std::uint32_t>(timestamps.passes.size() * 2)
+        };
+
+        const VkResult result {
+            vkGetQueryPoolResults(
+                device,
+                timestamps.query_pool,
+                0,
+                query_count,
+                query_count * 2 * sizeof(std::uint64_t),
+                results.data(),
+                2 * sizeof(std::uint64_t),
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+            )
+        };
+
+        if(result != VK_SUCCESS && result != VK_NOT_READY)
+        {
+            throw VulkanException{result};
+        }
+
+        for(std::size_t pass {}; pass < timestamps.passes.size(); ++pass)
+        {
+            const std::uint64_t begin {results[pass * 4]};
+            const std::uint64_t begin_available {results[pass * 4 + 1]};
+            const std::uint64_t end {results[pass * 4 + 2]};
+            const std::uint64_t end_available {results[pass * 4 + 3]};
+
+            if(!begin_available || !end_available)
+            {
+                continue;
+            }
+
+            const std::uint64_t ticks {(end - begin) & timestamp_mask};
+
+            pass_timings[timestamps.passes[pass]].addSample(
+                static_cast<double>(ticks) * timestamp_period / 1'000'000.0
+            );
+        }
+
+        timestamps.passes.clear();
+    }
+
+    std::unordered_map<std::string_view, GpuProfiler::PassStatistics> GpuProfiler::getStatistics() const
+    {
+        std::unordered_map<std::string_view, PassStatistics> statistics;
+
+        for(const auto& [pass_name, timings] : pass_timings)
+        {
+            statistics[pass_name] = PassStatistics{
+                .average_ms = timings.getAverage(),
+                .max_ms = timings.getMaximum(),
+                .sample_count = timings.getSampleCount()
+            };
+        }
+
+        return statistics;
+    }
+}
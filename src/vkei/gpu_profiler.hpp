@@ -0,0 +1,71 @@
+#pragma once
+
+#include "rolling_statistics.hpp"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    struct FrameTimestamps
+    {
+        VkQueryPool query_pool {};
+
+        // Pass names must outlive the profiler, string literals are expected
+        std::vector<std::string_view> passes;
+
+        bool pass_open {};
+    };
+
+    class GpuProfiler
+    {
+        public:
+            struct PassStatistics
+            {
+                double average_ms;
+                double max_ms;
+
+                std::size_t sample_count;
+            };
+
+            GpuProfiler() = default;
+
+            GpuProfiler(const GpuProfiler&) = delete;
+            GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+            void initialize(
+                const VkPhysicalDevice physical_device,
+                const std::uint32_t queue_family
+            );
+
+            void createQueryPool(const VkDevice device, FrameTimestamps& timestamps);
+            void destroyQueryPool(const VkDevice device, FrameTimestamps& timestamps);
+
+            void reset(const VkCommandBuffer command_buffer, FrameTimestamps& timestamps);
+
+            void beginPass(
+                const VkCommandBuffer command_buffer,
+                FrameTimestamps& timestamps,
+                const std::string_view pass_name
+            );
+
+            void endPass(const VkCommandBuffer command_buffer, FrameTimestamps& timestamps);
+
+            void collect(const VkDevice device, FrameTimestamps& timestamps);
+
+            std::unordered_map<std::string_view, PassStatistics> getStatistics() const;
+
+        private:
+            static constexpr std::uint32_t max_passes_per_frame {32};
+
+            bool enabled {};
+
+            double timestamp_period {};
+
+            std::uint64_t timestamp_mask {};
+
+            std::unordered_map<std::string_view, RollingStatistics> pass_timings;
+    };
+}
@@ -0,0 +1,536 @@
+#include "gpu_scene.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace mdsm::vkei
+{
+    void GpuScene::initialize(
+        const VkDevice device,
+        const VmaAllocator allocator,
+        const std::size_t frame_count,
+        const std::uint32_t object_capacity
+    )
+    {
+        this->device = device;
+        this->allocator = allocator;
+        this->object_capacity = object_capacity;
+
+        object_buffer = createObjectBuffer(object_capacity);
+
+        staging_buffers.assign(frame_count, StagingBuffer{});
+
+        resident.assign(object_capacity, GpuObject{});
+        slot_materials.assign(object_capacity, nullptr);
+        dirty_flags.assign(object_capacity, false);
+
+        command_capacity = min_batch_commands;
+    }
+
+    void GpuScene::destroy()
+    {
+        destroyBuffer(object_buffer);
+
+        for(const auto& staging : staging_buffers)
+        {
+            if(staging.capacity != 0)
+            {
+                vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+            }
+        }
+
+        staging_buffers.clear();
+        resident.clear();
+        slot_materials.clear();
+        batches.clear();
+        batch_ids.clear();
+        batch_order.clear();
+        pending.clear();
+        dirty_slots.clear();
+        dirty_flags.clear();
+
+        slot_count = 0;
+        live_objects = 0;
+        command_head = 0;
+    }
+
+    std::optional<GpuScene::ObjectBuffer> GpuScene::update(
+        const std::span<const RenderObject> objects,
+        const VkDeviceAddress vertex_buffer,
+        const UploadService& upload_service
+    )
+    {
+        std::optional<ObjectBuffer> retired;
+
+        if(objects.size() > object_capacity)
+        {
+            retired = object_buffer;
+
+            object_capacity = std::bit_ceil(static_cast<std::uint32_t>(objects.size()));
+            object_buffer = createObjectBuffer(object_capacity);
+
+            // A fresh buffer has no accesses to wait on
+            access_state = {};
+
+            resident.resize(object_capacity, GpuObject{});
+            slot_materials.resize(object_capacity, nullptr);
+            dirty_flags.resize(object_capacity, false);
+
+            for(std::uint32_t slot {}; slot < slot_count; ++slot)
+            {
+                markDirty(slot);
+            }
+
+            ++full_rewrites;
+        }
+
+        pending.clear();
+
+        const auto object_count {static_cast<std::uint32_t>(objects.size())};
+        const std::uint32_t previous_slot_count {slot_count};
+
+        // Region moves rewrite every slot below slot_count, new slots included
+        slot_count = std::max(slot_count, object_count);
+
+        for(std::uint32_t slot {}; slot < object_count; ++slot)
+        {
+            // Slots the buffer never held yet are uploaded even when they stay empty
+            if(slot >= previous_slot_count)
+            {
+                markDirty(slot);
+            }
+
+            const RenderObject& object {objects[slot]};
+
+            const GpuObject gpu_object {
+                .transform = object.transform,
+                .sphere = glm::vec4{object.bounds.origin, object.bounds.sphere_radius},
+                .first_index = object.first_index,
+                .index_count = object.index_count,
+                .batch = 0,
+                .command_offset = 0,
+                .vertex_buffer = vertex_buffer,
+                .vertex_offset = object.vertex_offset,
+                .material_index = object.material->material_index
+            };
+
+            if(!upload_service.isReady(object.upload_ticket))
+            {
+                pending.push_back(
+                    PendingObject{
+                        .slot = slot,
+                        .ticket = object.upload_ticket,
+                        .object = gpu_object,
+                        .material = object.material
+                    }
+                );
+
+                setObject(slot, GpuObject{}, nullptr);
+
+                continue;
+            }
+
+            setObject(slot, gpu_object, object.material);
+        }
+
+        for(std::uint32_t slot {object_count}; slot < previous_slot_count; ++slot)
+        {
+            setObject(slot, GpuObject{}, nullptr);
+        }
+
+        slot_count = object_count;
+
+        return retired;
+    }
+
+    void GpuScene::promotePending(const UploadService& upload_service)
+    {
+        for(std::size_t entry {}; entry < pending.size();)
+        {
+            if(!upload_service.isReady(pending[entry].ticket))
+            {
+                ++entry;
+
+                continue;
+            }
+
+            setObject(pending[entry].slot, pending[entry].object, pending[entry].material);
+
+            pending[entry] = pending.back();
+            pending.pop_back();
+        }
+    }
+
+    void GpuScene::setObject(
+        const std::uint32_t slot, GpuObject object, const MaterialInstance* const material
+    )
+    {
+        GpuObject& current {resident[slot]};
+
+        const bool was_live {current.index_count != 0};
+        const bool is_live {object.index_count != 0};
+
+        // Same material means same batch, so the batch fields can be carried over for the comparison
+        if(was_live && is_live && slot_materials[slot] == material)
+        {
+            object.batch = current.batch;
+            object.command_offset = current.command_offset;
+
+            if(std::memcmp(&object, &current, sizeof(GpuObject)) == 0)
+            {
+                return;
+            }
+
+            current = object;
+
+            markDirty(slot);
+
+            return;
+        }
+
+        if(!was_live && !is_live)
+        {
+            return;
+        }
+
+        if(was_live)
+        {
+            --batches[current.batch].object_count;
+            --live_objects;
+        }
+
+        if(is_live)
+        {
+            const std::uint32_t batch {getBatch(*material)};
+
+            reserveCommand(batch);
+
+            object.batch = batch;
+            object.command_offset = batches[batch].command_offset;
+
+            ++batches[batch].object_count;
+            ++live_objects;
+        }
+
+        current = object;
+        slot_materials[slot] = is_live? material : nullptr;
+
+        markDirty(slot);
+    }
+
+    std::uint32_t GpuScene::getBatch(const MaterialInstance& material)
+    {
+        const BatchKey key {material.pipeline, material.descriptor_set, material.descriptor_offset};
+
+        const auto [batch_id, inserted] {
+            batch_ids.try_emplace(key, static_cast<std::uint32_t>(batches.size()))
+        };
+
+        if(inserted)
+        {
+            batches.push_back(
+                Batch{
+                    .material = material,
+                    .command_offset = 0,
+                    .command_capacity = 0,
+                    .object_count = 0
+                }
+            );
+
+            batch_order.clear();
+
+            for(const auto& [batch_key, batch] : batch_ids)
+            {
+                batch_order.push_back(batch);
+            }
+        }
+
+        return batch_id->second;
+    }
+
+    void GpuScene::reserveCommand(const std::uint32_t batch)
+    {
+        Batch& target {batches[batch]};
+
+        if(target.object_count < target.command_capacity)
+        {
+            return;
+        }
+
+        const std::uint32_t region_size {std::max(target.command_capacity * 2, min_batch_commands)};
+
+        if(command_head + region_size > command_capacity)
+        {
+            packRegions(batch);
+
+            return;
+        }
+
+        // The old region is abandoned until the next repack
+        target.command_offset = command_head;
+        target.command_capacity = region_size;
+
+        command_head += region_size;
+
+        for(std::uint32_t slot {}; slot < slot_count; ++slot)
+        {
+            if(resident[slot].index_count != 0 && resident[slot].batch == batch)
+            {
+                resident[slot].command_offset = target.command_offset;
+
+                markDirty(slot);
+            }
+        }
+
+        ++region_moves;
+    }
+
+    void GpuScene::packRegions(const std::uint32_t growing_batch)
+    {
+        std::uint32_t required {};
+
+        for(std::uint32_t batch {}; batch < batches.size(); ++batch)
+        {
+            const std::uint32_t needed {batches[batch].object_count + (batch == growing_batch? 1u : 0u)};
+
+            batches[batch].command_capacity = needed == 0
+                ? 0
+                : std::max(std::bit_ceil(needed), min_batch_commands);
+
+            required += batches[batch].command_capacity;
+        }
+
+        // Leaves room for regions to move before the next repack
+        command_capacity = std::max(command_capacity, std::bit_ceil(required * 2));
+        command_head = 0;
+
+        for(auto& batch : batches)
+        {
+            batch.command_offset = command_head;
+            command_head += batch.command_capacity;
+        }
+
+        for(std::uint32_t slot {}; slot < slot_count; ++slot)
+        {
+            if(resident[slot].index_count != 0)
+            {
+                resident[slot].command_offset = batches[resident[slot].batch].command_offset;
+
+                markDirty(slot);
+            }
+        }
+
+        ++full_rewrites;
+    }
+
+    void GpuScene::markDirty(const std::uint32_t slot)
+    {
+        if(!dirty_flags[slot])
+        {
+            dirty_flags[slot] = true;
+            dirty_slots.push_back(slot);
+        }
+    }
+
+    bool GpuScene::hasDirtyObjects() const
+    {
+        return !dirty_slots.empty();
+    }
+
+    void GpuScene::recordUpload(const VkCommandBuffer command_buffer, const std::size_t frame_index)
+    {
+        uploaded_objects = dirty_slots.size();
+        upload_ranges = 0;
+
+        if(dirty_slots.empty())
+        {
+            return;
+        }
+
+        StagingBuffer& staging {staging_buffers[frame_index]};
+
+        // Only called after the frame's fence wait, nothing in flight reads the old staging buffer
+        if(dirty_slots.size() > staging.capacity)
+        {
+            if(staging.capacity != 0)
+            {
+                vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+            }
+
+            staging.capacity = std::bit_ceil(dirty_slots.size());
+
+            VkBufferCreateInfo buffer_info {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .pNext = nullptr
+            };
+
+            buffer_info.size = staging.capacity * sizeof(GpuObject);
+            buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+            VmaAllocationCreateInfo allocation_create_info {};
+
+            allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+            allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+            VmaAllocationInfo allocation_info;
+
+            check(
+                vmaCreateBuffer(
+                    allocator,
+                    &buffer_info,
+                    &allocation_create_info,
+                    &staging.buffer,
+                    &staging.allocation,
+                    &allocation_info
+                )
+            );
+
+            staging.data = reinterpret_cast<GpuObject*>(allocation_info.pMappedData);
+        }
+
+        std::ranges::sort(dirty_slots);
+
+        std::vector<VkBufferCopy> copies;
+
+        for(std::size_t entry {}; entry < dirty_slots.size(); ++entry)
+        {
+            const std::uint32_t slot {dirty_slots[entry]};
+
+            staging.data[entry] = resident[slot];
+            dirty_flags[slot] = false;
+
+            // Consecutive slots share one copy region
+            if(
+                !copies.empty()
+                && copies.back().dstOffset + copies.back().size == slot * sizeof(GpuObject)
+            )
+            {
+                copies.back().size += sizeof(GpuObject);
+
+                continue;
+            }
+
+            copies.push_back(
+                VkBufferCopy{
+                    .srcOffset = entry * sizeof(GpuObject),
+                    .dstOffset = slot * sizeof(GpuObject),
+                    .size = sizeof(GpuObject)
+                }
+            );
+        }
+
+        check(
+            vmaFlushAllocation(allocator, staging.allocation, 0, dirty_slots.size() * sizeof(GpuObject))
+        );
+
+        vkCmdCopyBuffer(
+            command_buffer,
+            staging.buffer,
+            object_buffer.buffer,
+            static_cast<std::uint32_t>(copies.size()),
+            copies.data()
+        );
+
+        upload_ranges = copies.size();
+
+        dirty_slots.clear();
+    }
+
+    void GpuScene::destroyBuffer(const ObjectBuffer& object_buffer)
+    {
+        vmaDestroyBuffer(allocator, object_buffer.buffer, object_buffer.allocation);
+    }
+
+    VkBuffer GpuScene::getObjectBuffer() const
+    {
+        return object_buffer.buffer;
+    }
+
+    VkDeviceAddress GpuScene::getObjectBufferAddress() const
+    {
+        return object_buffer_address;
+    }
+
+    AccessState& GpuScene::getAccessState()
+    {
+        return access_state;
+    }
+
+    std::uint32_t GpuScene::getSlotCount() const
+    {
+        return slot_count;
+    }
+
+    std::uint32_t GpuScene::getCommandCapacity() const
+    {
+        return command_capacity;
+    }
+
+    const std::vector<GpuScene::Batch>& GpuScene::getBatches() const
+    {
+        return batches;
+    }
+
+    const std::vector<std::uint32_t>& GpuScene::getBatchOrder() const
+    {
+        return batch_order;
+    }
+
+    GpuScene::SceneStatistics GpuScene::getStatistics() const
+    {
+        return SceneStatistics{
+            .slot_count = slot_count,
+            .live_objects = live_objects,
+            .pending_objects = pending.size(),
+            .batch_count = batches.size(),
+            .command_capacity = command_capacity,
+            .uploaded_objects = uploaded_objects,
+            .upload_ranges = upload_ranges,
+            .region_moves = region_moves,
+            .full_rewrites = full_rewrites
+        };
+    }
+
+    GpuScene::ObjectBuffer GpuScene::createObjectBuffer(const std::uint32_t capacity)
+    {
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = capacity * sizeof(GpuObject);
+        buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        VmaAllocationCreateInfo allocation_create_info {};
+
+        allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        ObjectBuffer new_buffer;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &buffer_info,
+                &allocation_create_info,
+                &new_buffer.buffer,
+                &new_buffer.allocation,
+                nullptr
+            )
+        );
+
+        VkBufferDeviceAddressInfo device_address_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr
+        };
+
+        device_address_info.buffer = new_buffer.buffer;
+
+        object_buffer_address = vkGetBufferDeviceAddress(device, &device_address_info);
+
+        return new_buffer;
+    }
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "barrier_batch.hpp"
+#include "gpu_culler.hpp"
+#include "types.hpp"
+#include "upload_service.hpp"
+#include "vk_mem_alloc.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Device-resident GpuObjects of the GPU-driven path. Objects keep their slot across frames,
+    // only slots whose contents changed are copied, and every batch owns a command region that
+    // only moves when it outgrows it, so unchanged frames cost nothing on the CPU
+    class GpuScene
+    {
+        public:
+            struct ObjectBuffer
+            {
+                VkBuffer buffer;
+                VmaAllocation allocation;
+            };
+
+            // Objects sharing pipeline and material, drawn with one indirect-count draw
+            struct Batch
+            {
+                // A copy, any material with the batch's key binds the same state
+                MaterialInstance material;
+
+                std::uint32_t command_offset;
+                std::uint32_t command_capacity;
+
+                std::uint32_t object_count;
+            };
+
+            struct SceneStatistics
+            {
+                std::size_t slot_count;
+                std::size_t live_objects;
+
+                // Waiting for their geometry or textures to upload
+                std::size_t pending_objects;
+
+                std::size_t batch_count;
+                std::uint32_t command_capacity;
+
+                // Of the last recorded upload
+                std::size_t uploaded_objects;
+                std::size_t upload_ranges;
+
+                // Command region moves and buffer growths that rewrote more than the changed slots
+                std::size_t region_moves;
+                std::size_t full_rewrites;
+            };
+
+            GpuScene() = default;
+
+            GpuScene(const GpuScene&) = delete;
+            GpuScene& operator=(const GpuScene&) = delete;
+
+            void initialize(
+                const VkDevice device,
+                const VmaAllocator allocator,
+                const std::size_t frame_count,
+                const std::uint32_t object_capacity
+            );
+
+            void destroy();
+
+            // Diffs the surfaces against the resident objects, surface i lives in slot i. Returns the
+            // previous object buffer when it had to grow, it must outlive the frames still reading it
+            std::optional<ObjectBuffer> update(
+                const std::span<const RenderObject> objects,
+                const VkDeviceAddress vertex_buffer,
+                const UploadService& upload_service
+            );
+
+            // Makes objects whose uploads finished visible, only walks the pending ones
+            void promotePending(const UploadService& upload_service);
+
+            bool hasDirtyObjects() const;
+
+            // Copies the changed slots through the frame's staging buffer
+            void recordUpload(const VkCommandBuffer command_buffer, const std::size_t frame_index);
+
+            void destroyBuffer(const ObjectBuffer& object_buffer);
+
+            VkBuffer getObjectBuffer() const;
+            VkDeviceAddress getObjectBufferAddress() const;
+
+            // Carried across frames, the upload of one frame must wait for the reads of the last
+            AccessState& getAccessState();
+
+            std::uint32_t getSlotCount() const;
+            std::uint32_t getCommandCapacity() const;
+
+            const std::vector<Batch>& getBatches() const;
+
+            // Batch indices ordered by pipeline, then material
+            const std::vector<std::uint32_t>& getBatchOrder() const;
+
+            SceneStatistics getStatistics() const;
+
+        private:
+            using BatchKey = std::tuple<const MaterialPipeline*, VkDescriptorSet, VkDeviceSize>;
+
+            struct PendingObject
+            {
+                std::uint32_t slot;
+                std::uint64_t ticket;
+
+                GpuObject object;
+                const MaterialInstance* material;
+            };
+
+            struct StagingBuffer
+            {
+                VkBuffer buffer;
+                VmaAllocation allocation;
+
+                GpuObject* data;
+
+                std::size_t capacity;
+            };
+
+            static constexpr std::uint32_t min_batch_commands {64};
+
+            VkDevice device {};
+            VmaAllocator allocator {};
+
+            ObjectBuffer object_buffer {};
+            VkDeviceAddress object_buffer_address {};
+            std::uint32_t object_capacity {};
+
+            AccessState access_state {};
+
+            std::vector<StagingBuffer> staging_buffers;
+
+            // CPU copy of what the object buffer holds, empty slots have no indices
+            std::vector<GpuObject> resident;
+            std::vector<const MaterialInstance*> slot_materials;
+
+            std::uint32_t slot_count {};
+            std::size_t live_objects {};
+
+            std::vector<Batch> batches;
+            std::map<BatchKey, std::uint32_t> batch_ids;
+            std::vector<std::uint32_t> batch_order;
+
+            std::uint32_t command_head {};
+            std::uint32_t command_capacity {};
+
+            std::vector<bool> dirty_flags;
+            std::vector<std::uint32_t> dirty_slots;
+
+            std::vector<PendingObject> pending;
+
+            std::size_t uploaded_objects {};
+            std::size_t upload_ranges {};
+            std::size_t region_moves {};
+            std::size_t full_rewrites {};
+
+            void setObject(const std::uint32_t slot, GpuObject object, const MaterialInstance* const material);
+
+            std::uint32_t getBatch(const MaterialInstance& material);
+
+            // Gives the batch room for one more command, moving its region or repacking every region
+            void reserveCommand(const std::uint32_t batch);
+
+            // Every non-empty region gets packed again, the growing batch with room for one more
+            void packRegions(const std::uint32_t growing_batch);
+
+            void markDirty(const std::uint32_t slot);
+
+            ObjectBuffer createObjectBuffer(const std::uint32_t capacity);
+    };
+}
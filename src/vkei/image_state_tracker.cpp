@@ -0,0 +1,47 @@
+#include "image_state_tracker.hpp"
+
+namespace mdsm::vkei
+{
+    void ImageStateTracker::track(const AllocatedImage& image, const VkImageLayout layout)
+    {
+        const VkImageAspectFlags aspect_mask {
+            image.image_format == VK_FORMAT_D32_SFLOAT? 
+                VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT
+        };
+
+        images.insert_or_assign(
+            image.image,
+            TrackedImage{
+                .aspect_mask = aspect_mask,
+                .state = AccessState{.layout = layout}
+            }
+        );
+    }
+
+    void ImageStateTracker::untrack(const VkImage image)
+    {
+        images.erase(image);
+    }
+
+    void ImageStateTracker::use(BarrierBatch& batch, const VkImage image, const ResourceUsage usage)
+    {
+        TrackedImage& tracked_image {images.at(image)};
+
+        batch.useImage(tracked_image.state, image, tracked_image.aspect_mask, usage);
+    }
+
+    void ImageStateTracker::discard(const VkImage image)
+    {
+        images.at(image).state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    AccessState& ImageStateTracker::getState(const VkImage image)
+    {
+        return images.at(image).state;
+    }
+
+    VkImageAspectFlags ImageStateTracker::getAspectMask(const VkImage image) const
+    {
+        return images.at(image).aspect_mask;
+    }
+}
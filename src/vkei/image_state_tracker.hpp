@@ -0,0 +1,45 @@
+#pragma once
+
+#include "barrier_batch.hpp"
+#include "resource_usage.hpp"
+#include "types.hpp"
+#include <unordered_map>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Remembers the layout and last access of every image the engine owns
+    class ImageStateTracker
+    {
+        public:
+            ImageStateTracker() = default;
+
+            ImageStateTracker(const ImageStateTracker&) = delete;
+            ImageStateTracker& operator=(const ImageStateTracker&) = delete;
+
+            void track(const AllocatedImage& image, const VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+            void untrack(const VkImage image);
+
+            // Queues the barrier the usage needs into the batch
+            void use(BarrierBatch& batch, const VkImage image, const ResourceUsage usage);
+
+            // The next use may drop the current contents
+            void discard(const VkImage image);
+
+            AccessState& getState(const VkImage image);
+
+            VkImageAspectFlags getAspectMask(const VkImage image) const;
+
+        private:
+            struct TrackedImage
+            {
+                VkImageAspectFlags aspect_mask;
+
+                AccessState state;
+            };
+
+            // Node-based so references handed out by getState survive insertions
+            std::unordered_map<VkImage, TrackedImage> images;
+    };
+}
@@ -0,0 +1,243 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+namespace mdsm::vkei
+{
+    namespace
+    {
+        thread_local const JobSystem* current_system {};
+        thread_local std::size_t current_queue_index {};
+    }
+
+    bool JobCounter::isDone() const
+    {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+    JobSystem::JobSystem(const std::size_t worker_count)
+    {
+        const std::size_t effective_worker_count {
+            worker_count? 
+                worker_count 
+                : std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1
+        };
+
+        for(std::size_t queue {}; queue <= effective_worker_count; ++queue)
+        {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        for(std::size_t worker {}; worker < effective_worker_count; ++worker)
+        {
+            workers.emplace_back(&JobSystem::workerLoop, this, worker + 1);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard lock {sleep_mutex};
+
+            stopping = true;
+        }
+
+        sleep_condition.notify_all();
+
+        workers.clear();
+    }
+
+    std::size_t JobSystem::getWorkerCount() const
+    {
+        return workers.size();
+    }
+
+    JobSystem::JobStatistics JobSystem::getStatistics() const
+    {
+        return JobStatistics{
+            .executed_jobs = executed_jobs.load(std::memory_order_relaxed),
+            .stolen_jobs = stolen_jobs.load(std::memory_order_relaxed)
+        };
+    }
+
+    std::size_t JobSystem::getQueueIndex() const
+    {
+        return current_system == this? current_queue_index : 0;
+    }
+
+    void JobSystem::submit(
+        std::function<void()>&& job,
+        JobCounter* const counter,
+        JobCounter* const dependency
+    )
+    {
+        if(counter)
+        {
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if(dependency)
+        {
+            std::lock_guard lock {dependency->deferred_mutex};
+
+            if(!dependency->isDone())
+            {
+                dependency->deferred_jobs.push_back(
+                    JobCounter::DeferredJob{
+                        .function = std::move(job),
+                        .counter = counter
+                    }
+                );
+
+                return;
+            }
+        }
+
+        enqueue(Job{.function = std::move(job), .counter = counter});
+    }
+
+    void JobSystem::enqueue(Job&& job)
+    {
+        {
+            WorkQueue& queue {*queues[getQueueIndex()]};
+
+            std::lock_guard lock {queue.mutex};
+
+            queue.jobs.push_back(std::move(job));
+        }
+
+        {
+            std::lock_guard lock {sleep_mutex};
+
+            queued_jobs.fetch_add(1, std::memory_order_release);
+        }
+
+        sleep_condition.notify_one();
+    }
+
+    bool JobSystem::runPendingJob()
+    {
+        const std::size_t own_index {getQueueIndex()};
+
+        Job job;
+
+        bool found {};
+
+        {
+            WorkQueue& own_queue {*queues[own_index]};
+
+            std::lock_guard lock {own_queue.mutex};
+
+            if(!own_queue.jobs.empty())
+            {
+                job = std::move(own_queue.jobs.back());
+
+                own_queue.jobs.pop_back();
+
+                found = true;
+            }
+        }
+
+        for(std::size_t offset {1}; !found && offset < queues.size(); ++offset)
+        {
+            WorkQueue& victim {*queues[(own_index + offset) % queues.size()]};
+
+            std::lock_guard lock {victim.mutex};
+
+            if(!victim.jobs.empty())
+            {
+                job = std::move(victim.jobs.front());
+
+                victim.jobs.pop_front();
+
+                found = true;
+
+                stolen_jobs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if(!found)
+        {
+            return false;
+        }
+
+        queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+
+        job.function();
+
+        executed_jobs.fetch_add(1, std::memory_order_relaxed);
+
+        finishJob(job.counter);
+
+        return true;
+    }
+
+    void JobSystem::finishJob(JobCounter* const counter)
+    {
+        if(!counter)
+        {
+            return;
+        }
+
+        std::vector<JobCounter::DeferredJob> released_jobs;
+
+        {
+            std::lock_guard lock {counter->deferred_mutex};
+
+            if(counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+
+            released_jobs.swap(counter->deferred_jobs);
+        }
+
+        for(auto& released_job : released_jobs)
+        {
+            enqueue(Job{.function = std::move(released_job.function), .counter = released_job.counter});
+        }
+    }
+
+    void JobSystem::wait(const JobCounter& counter)
+    {
+        while(!counter.isDone())
+        {
+            if(!runPendingJob())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // The last finisher may still hold the lock, the counter must not be destroyed before it lets go
+        std::lock_guard lock {counter.deferred_mutex};
+    }
+
+    void JobSystem::workerLoop(const std::size_t queue_index)
+    {
+        current_system = this;
+        current_queue_index = queue_index;
+
+        while(true)
+        {
+            if(runPendingJob())
+            {
+                continue;
+            }
+
+            std::unique_lock lock {sleep_mutex};
+
+            sleep_condition.wait(
+                lock,
+                [this]
+                {
+                    return stopping || queued_jobs.load(std::memory_order_acquire) > 0;
+                }
+            );
+
+            if(stopping)
+            {
+                return;
+            }
+        }
+    }
+}
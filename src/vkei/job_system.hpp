@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mdsm::vkei
+{
+    class JobSystem;
+
+    // Tracks a group of jobs, jobs submitted with a dependency start once it reaches zero
+    class JobCounter
+    {
+        public:
+            JobCounter() = default;
+
+            JobCounter(const JobCounter&) = delete;
+            JobCounter& operator=(const JobCounter&) = delete;
+
+            bool isDone() const;
+
+        private:
+            friend class JobSystem;
+
+            struct DeferredJob
+            {
+                std::function<void()> function;
+
+                JobCounter* counter;
+            };
+
+            std::atomic<std::size_t> pending {};
+
+            mutable std::mutex deferred_mutex;
+            std::vector<DeferredJob> deferred_jobs;
+    };
+
+    class JobSystem
+    {
+        public:
+            struct JobStatistics
+            {
+                std::size_t executed_jobs;
+                std::size_t stolen_jobs;
+            };
+
+            // Zero starts one worker per hardware thread, leaving one for the calling thread
+            explicit JobSystem(const std::size_t worker_count = 0);
+
+            ~JobSystem();
+
+            JobSystem(const JobSystem&) = delete;
+            JobSystem& operator=(const JobSystem&) = delete;
+
+            void submit(
+                std::function<void()>&& job,
+                JobCounter* const counter = nullptr,
+                JobCounter* const dependency = nullptr
+            );
+
+            // Runs queued jobs on the calling thread until the counter reaches zero
+            void wait(const JobCounter& counter);
+
+            // Calls function(begin, end) over [0, count) in ranges of at most grain_size
+            template<typename Function>
+            void parallelFor(const std::size_t count, const std::size_t grain_size, Function&& function);
+
+            std::size_t getWorkerCount() const;
+
+            // 1 to getWorkerCount() on workers, 0 on every other thread
+            std::size_t getQueueIndex() const;
+
+            JobStatistics getStatistics() const;
+
+        private:
+            struct Job
+            {
+                std::function<void()> function;
+
+                JobCounter* counter;
+            };
+
+            // Owners pop from the back, thieves take from the front
+            struct WorkQueue
+            {
+                std::mutex mutex;
+                std::deque<Job> jobs;
+            };
+
+            // Index 0 is shared by every thread that is not a worker
+            std::vector<std::unique_ptr<WorkQueue>> queues;
+
+            std::vector<std::jthread> workers;
+
+            std::atomic<std::size_t> queued_jobs {};
+
+            std::mutex sleep_mutex;
+            std::condition_variable sleep_condition;
+
+            std::atomic<bool> stopping {};
+
+            std::atomic<std::size_t> executed_jobs {};
+            std::atomic<std::size_t> stolen_jobs {};
+
+            void workerLoop(const std::size_t queue_index);
+
+            void enqueue(Job&& job);
+
+            bool runPendingJob();
+
+            void finishJob(JobCounter* const counter);
+    };
+
+    template<typename Function>
+    void JobSystem::parallelFor(
+        const std::size_t count, const std::size_t grain_size, Function&& function
+    )
+    {
+        if(count == 0)
+        {
+            return;
+        }
+
+        const std::size_t range_size {std::max<std::size_t>(grain_size, 1)};
+
+        JobCounter counter;
+
+        for(std::size_t begin {range_size}; begin < count; begin += range_size)
+        {
+            const std::size_t end {std::min(begin + range_size, count)};
+
+            submit(
+                [&function, begin, end]
+                {
+                    function(begin, end);
+                },
+                &counter
+            );
+        }
+
+        function(std::size_t{0}, std::min(range_size, count));
+
+        wait(counter);
+    }
+}
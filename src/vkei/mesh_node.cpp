@@ -1,5 +1,7 @@
 #include "mesh_node.hpp"
+#include "geometry_pool.hpp"
 #include "types.hpp"
+#include <algorithm>
 
 namespace mdsm::vkei
 {
@@ -9,19 +11,33 @@ namespace mdsm::vkei
             top_matrix * world_transform
         };
 
+        const GeometryPool::Range& range {
+            context.geometry_pool->getRange(mesh->mesh_buffers.geometry_handle)
+        };
+
         for(auto& surface : mesh->surfaces)
         {
             RenderObject def;
 
             def.index_count = surface.count;
-            def.first_index = surface.start_index;
-            def.index_buffer = mesh->mesh_buffers.index_buffer.buffer;
+            def.first_index = range.first_index + surface.start_index;
+            def.vertex_offset = static_cast<std::int32_t>(range.first_vertex);
             def.material = &surface.material->data;
 
             def.transform = node_matrix;
-            def.vertex_buffer_address = mesh->mesh_buffers.vertex_buffer_address;
+            def.bounds = surface.bounds;
+            def.upload_ticket = std::max(
+                mesh->mesh_buffers.upload_ticket, surface.material->data.upload_ticket
+            );
 
-            context.opaque_surfaces.push_back(def);
+            if(surface.material->data.pass_type == MaterialPass::Transparent)
+            {
+                context.transparent_surfaces.push_back(def);
+            }
+            else
+            {
+                context.opaque_surfaces.push_back(def);
+            }
         }
     }
 }
\ No newline at end of file
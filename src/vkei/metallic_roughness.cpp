@@ -1,6 +1,7 @@
 #include "metallic_roughness.hpp"
 #include "descriptor_layout_builder.hpp"
 #include "types.hpp"
+#include <algorithm>
 #include <format>
 #include <vulkan/vk_enum_string_helper.h>
 #include <vulkan/vulkan_core.h>
@@ -29,11 +30,15 @@ namespace mdsm::vkei
             nullptr
         );
 
-        vkDestroyDescriptorSetLayout(
-            device, 
-            material_layout, 
-            nullptr
-        );
+        // The bindless layout belongs to the table
+        if(!bindless_table)
+        {
+            vkDestroyDescriptorSetLayout(
+                device, 
+                material_layout, 
+                nullptr
+            );
+        }
 
         vkDestroyPipeline(
             device, 
@@ -46,25 +51,32 @@ namespace mdsm::vkei
             transparent_pipeline.pipeline, 
             nullptr
         );        
+
+        vkDestroyPipeline(device, opaque_pipeline.indirect_pipeline, nullptr);
+        vkDestroyPipeline(device, transparent_pipeline.indirect_pipeline, nullptr);
     }
 
     MetallicRoughness::MetallicRoughness()
     :
         fragment_shader {VK_SHADER_STAGE_FRAGMENT_BIT},
-        vertex_shader   {VK_SHADER_STAGE_VERTEX_BIT}
+        vertex_shader   {VK_SHADER_STAGE_VERTEX_BIT},
+        indirect_vertex_shader {VK_SHADER_STAGE_VERTEX_BIT}
     {
     }
 
     void MetallicRoughness::buildPipeline(
         Engine* engine, 
         const std::string_view vertex_shader_path,
+        const std::string_view indirect_vertex_shader_path,
         const std::string_view fragment_shader_path       
     )
     {
         vertex_shader.setPath(vertex_shader_path);
+        indirect_vertex_shader.setPath(indirect_vertex_shader_path);
         fragment_shader.setPath(fragment_shader_path);
 
         vertex_shader.compile(engine->logical_device);
+        indirect_vertex_shader.compile(engine->logical_device);
         fragment_shader.compile(engine->logical_device);
 
         VkPushConstantRange matrix_range {};
@@ -73,16 +85,25 @@ namespace mdsm::vkei
         matrix_range.size = sizeof(DrawPushCostants);
         matrix_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-        DescriptorLayoutBuilder layout_builder;
-
-        layout_builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-        layout_builder.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        layout_builder.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-        material_layout = layout_builder.build(
-            engine->logical_device, 
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
-        );
+        if(bindless_table)
+        {
+            material_layout = bindless_table->getLayout();
+        }
+        else
+        {
+            DescriptorLayoutBuilder layout_builder;
+
+            layout_builder.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+            layout_builder.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+            layout_builder.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+            material_layout = layout_builder.build(
+                engine->logical_device, 
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                nullptr,
+                descriptor_buffer? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0
+            );
+        }
 
         VkDescriptorSetLayout layouts[] {
             engine->scene_data_descriptor_layout,
@@ -133,14 +154,28 @@ namespace mdsm::vkei
 
         pipeline_builder.pipeline_layout = new_layout;
 
+        if(descriptor_buffer)
+        {
+            pipeline_builder.create_flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        }
+
         opaque_pipeline.pipeline = pipeline_builder.build(engine->logical_device);
 
+        pipeline_builder.setShaders(indirect_vertex_shader, fragment_shader);
+
+        opaque_pipeline.indirect_pipeline = pipeline_builder.build(engine->logical_device);
+
         pipeline_builder.enableAddictiveBlending();
         pipeline_builder.enableDepthTest(false, VK_COMPARE_OP_GREATER_OR_EQUAL);
 
+        transparent_pipeline.indirect_pipeline = pipeline_builder.build(engine->logical_device);
+
+        pipeline_builder.setShaders(vertex_shader, fragment_shader);
+
         transparent_pipeline.pipeline = pipeline_builder.build(engine->logical_device);
 
         vertex_shader.destroy(engine->logical_device);
+        indirect_vertex_shader.destroy(engine->logical_device);
         fragment_shader.destroy(engine->logical_device);
     }
 
@@ -148,12 +183,28 @@ namespace mdsm::vkei
         const VkDevice device,
         const MaterialPass pass,
         const MaterialResources& resources,
-        DescriptorAllocator& descriptor_allocator
+        DescriptorAllocator& descriptor_allocator,
+        DescriptorSetCache* const descriptor_cache
+    )
+    {
+        return writeMaterial(device, pass, resources, descriptor_allocator, writer, descriptor_cache);
+    }
+
+    MaterialInstance MetallicRoughness::writeMaterial(
+        const VkDevice device,
+        const MaterialPass pass,
+        const MaterialResources& resources,
+        DescriptorAllocator& descriptor_allocator,
+        DescriptorWriter& writer,
+        DescriptorSetCache* const descriptor_cache
     )
     {
         MaterialInstance material_data;
 
         material_data.pass_type = pass;
+        material_data.upload_ticket = std::max(
+            resources.color_image.upload_ticket, resources.metal_roughness_image.upload_ticket
+        );
 
         if(pass == MaterialPass::Transparent)
         {
@@ -164,7 +215,25 @@ namespace mdsm::vkei
             material_data.pipeline = &opaque_pipeline;
         }
 
-        material_data.descriptor_set = descriptor_allocator.allocate(device, material_layout);
+        if(bindless_table)
+        {
+            const BindlessTable::MaterialRecord record {
+                .color_factors = resources.constants->color_factors,
+                .metal_roughness_factors = resources.constants->metal_roughness_factor,
+                .color_texture = bindless_table->addTexture(
+                    resources.color_image.image_view, resources.color_sampler
+                ),
+                .metal_roughness_texture = bindless_table->addTexture(
+                    resources.metal_roughness_image.image_view, resources.metal_roughness_sampler
+                ),
+                .padding = {}
+            };
+
+            material_data.descriptor_set = bindless_table->getDescriptorSet();
+            material_data.material_index = bindless_table->addMaterial(record);
+
+            return material_data;
+        }
 
         writer.clear();
 
@@ -192,6 +261,28 @@ namespace mdsm::vkei
             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
         );
 
+        if(descriptor_buffer)
+        {
+            material_data.descriptor_set = VK_NULL_HANDLE;
+            material_data.descriptor_offset = writer.writeDescriptorBuffer(
+                device, material_layout, *descriptor_buffer
+            );
+
+            return material_data;
+        }
+
+        // Materials with the same buffer range, images and samplers share one set
+        if(descriptor_cache)
+        {
+            material_data.descriptor_set = descriptor_cache->getDescriptorSet(
+                device, material_layout, writer, descriptor_allocator
+            );
+
+            return material_data;
+        }
+
+        material_data.descriptor_set = descriptor_allocator.allocate(device, material_layout);
+
         writer.updateDescriptorSet(device, material_data.descriptor_set);
 
         return material_data;
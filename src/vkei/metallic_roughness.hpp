@@ -1,6 +1,8 @@
 #pragma once
 
+#include "bindless_table.hpp"
 #include "descriptor_allocator.hpp"
+#include "descriptor_set_cache.hpp"
 #include "types.hpp"
 #include <cstdint>
 #include <stdexcept>
@@ -28,6 +30,12 @@ namespace mdsm::vkei
 
         VkDescriptorSetLayout material_layout;
 
+        // When set, materials are entries of the table and share its descriptor set and layout
+        BindlessTable* bindless_table {};
+
+        // When set, material descriptors are written into the buffer instead of allocated sets
+        DescriptorBuffer* descriptor_buffer {};
+
         struct MaterialConstants
         {
             glm::vec4 color_factors;
@@ -49,6 +57,16 @@ namespace mdsm::vkei
             VkBuffer data_buffer;
 
             std::uint32_t data_buffer_offset;
+
+            // Copied into the bindless table instead of reading data_buffer
+            const MaterialConstants* constants {};
+        };
+
+        struct MaterialRequest
+        {
+            MaterialPass pass;
+
+            MaterialResources resources;
         };
 
         DescriptorWriter writer;
@@ -56,6 +74,7 @@ namespace mdsm::vkei
         void buildPipeline(
             Engine* engine,
             const std::string_view vertex_shader_path,
+            const std::string_view indirect_vertex_shader_path,
             const std::string_view fragment_shader_path
         );
         
@@ -65,10 +84,23 @@ namespace mdsm::vkei
             const VkDevice device,
             const MaterialPass pass,
             const MaterialResources& resources,
-            DescriptorAllocator& descriptor_allocator
+            DescriptorAllocator& descriptor_allocator,
+            DescriptorSetCache* const descriptor_cache = nullptr
+        );
+
+        // Leaves the shared writer alone, safe to call from several threads at once
+        // as long as each one passes its own allocator and writer
+        MaterialInstance writeMaterial(
+            const VkDevice device,
+            const MaterialPass pass,
+            const MaterialResources& resources,
+            DescriptorAllocator& descriptor_allocator,
+            DescriptorWriter& writer,
+            DescriptorSetCache* const descriptor_cache = nullptr
         );
 
         Shader vertex_shader;
+        Shader indirect_vertex_shader;
         Shader fragment_shader;
     };
 }
\ No newline at end of file
@@ -78,6 +78,8 @@ namespace mdsm::vkei
         };
     
         shader_stages.clear();
+
+        create_flags = {};
     }
     
     void PipelineBuilder::setShaders(const VkShaderModule vertex_shader, const VkShaderModule fragment_shader)
@@ -196,6 +198,7 @@ namespace mdsm::vkei
         };
     
         pipeline_info.pNext = &render_info;
+        pipeline_info.flags = create_flags;
     
         pipeline_info.stageCount = static_cast<std::uint32_t>(shader_stages.size());
         pipeline_info.pStages = shader_stages.data();
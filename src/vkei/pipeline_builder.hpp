@@ -57,5 +57,7 @@ namespace mdsm::vkei
             VkPipelineDepthStencilStateCreateInfo depth_stencil;
             VkPipelineRenderingCreateInfo render_info;
             VkFormat color_attachment_format;
+
+            VkPipelineCreateFlags create_flags;
     };
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "radix_sort.hpp"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace mdsm::vkei
+{
+    void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+    {
+        constexpr std::size_t digit_bits {8};
+        constexpr std::size_t digit_count {64 / digit_bits};
+        constexpr std::size_t bucket_count {1 << digit_bits};
+
+        if(items.size() < 2)
+        {
+            return;
+        }
+
+        // All histograms are gathered in one pass over the keys
+        std::array<std::array<std::size_t, bucket_count>, digit_count> histograms {};
+
+        for(const auto& item : items)
+        {
+            for(std::size_t digit {}; digit < digit_count; ++digit)
+            {
+                ++histograms[digit][(item.key >> (digit * digit_bits)) & (bucket_count - 1)];
+            }
+        }
+
+        scratch.resize(items.size());
+
+        for(std::size_t digit {}; digit < digit_count; ++digit)
+        {
+            auto& histogram {histograms[digit]};
+
+            const std::size_t first_bucket {
+                (items.front().key >> (digit * digit_bits)) & (bucket_count - 1)
+            };
+
+            // Every key shares this digit, the pass would not move anything
+            if(histogram[first_bucket] == items.size())
+            {
+                continue;
+            }
+
+            std::size_t offset {};
+
+            for(auto& bucket : histogram)
+            {
+                offset += std::exchange(bucket, offset);
+            }
+
+            for(const auto& item : items)
+            {
+                scratch[histogram[(item.key >> (digit * digit_bits)) & (bucket_count - 1)]++] = item;
+            }
+
+            items.swap(scratch);
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mdsm::vkei
+{
+    struct SortItem
+    {
+        std::uint64_t key;
+
+        // Usually an index into the array being ordered
+        std::uint32_t value;
+    };
+
+    // Stable LSD radix sort on the key, scratch is resized as needed and can be reused
+    void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+}
@@ -0,0 +1,193 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+
+namespace mdsm::vkei
+{
+    void RenderGraph::reset()
+    {
+        resources.clear();
+        passes.clear();
+        owned_states.clear();
+
+        barrier_batch.clear();
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importImage(
+        const VkImage image,
+        const VkImageAspectFlags aspect_mask,
+        AccessState& state
+    )
+    {
+        resources.push_back(
+            ResourceState{
+                .image = image,
+                .buffer = VK_NULL_HANDLE,
+                .aspect_mask = aspect_mask,
+                .state = &state,
+                .final_usage = std::nullopt
+            }
+        );
+
+        return static_cast<ResourceHandle>(resources.size() - 1);
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importImage(
+        const VkImage image,
+        const VkImageAspectFlags aspect_mask,
+        const VkImageLayout initial_layout,
+        const VkPipelineStageFlags2 initial_stages
+    )
+    {
+        AccessState& state {
+            owned_states.emplace_back(
+                AccessState{
+                    .layout = initial_layout,
+                    .write_stages = initial_stages
+                }
+            )
+        };
+
+        return importImage(image, aspect_mask, state);
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importBuffer(const VkBuffer buffer)
+    {
+        return importBuffer(buffer, owned_states.emplace_back());
+    }
+
+    RenderGraph::ResourceHandle RenderGraph::importBuffer(const VkBuffer buffer, AccessState& state)
+    {
+        resources.push_back(
+            ResourceState{
+                .image = VK_NULL_HANDLE,
+                .buffer = buffer,
+                .aspect_mask = 0,
+                .state = &state,
+                .final_usage = std::nullopt
+            }
+        );
+
+        return static_cast<ResourceHandle>(resources.size() - 1);
+    }
+
+    void RenderGraph::addPass(
+        const std::string_view name,
+        const std::initializer_list<Access> accesses,
+        std::function<void(const VkCommandBuffer command_buffer)>&& record
+    )
+    {
+        passes.push_back(
+            Pass{
+                .name = name,
+                .accesses = accesses,
+                .record = std::move(record),
+                .culled = false
+            }
+        );
+    }
+
+    void RenderGraph::setOutput(const ResourceHandle resource, const ResourceUsage final_usage)
+    {
+        resources[resource].final_usage = final_usage;
+    }
+
+    const RenderGraph::GraphStatistics& RenderGraph::getStatistics() const
+    {
+        return statistics;
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        std::vector<bool> needed(resources.size());
+
+        for(std::size_t resource {}; resource < resources.size(); ++resource)
+        {
+            needed[resource] = resources[resource].final_usage.has_value();
+        }
+
+        for(auto pass {passes.rbegin()}; pass != passes.rend(); ++pass)
+        {
+            pass->culled = std::ranges::none_of(
+                pass->accesses,
+                [&](const Access& access)
+                {
+                    return getResourceUsageInfo(access.usage).writes && needed[access.resource];
+                }
+            );
+
+            if(pass->culled)
+            {
+                continue;
+            }
+
+            // Writes may load previous contents, so everything a live pass touches stays needed
+            for(const auto& access : pass->accesses)
+            {
+                needed[access.resource] = true;
+            }
+        }
+    }
+
+    void RenderGraph::use(const ResourceHandle resource, const ResourceUsage usage)
+    {
+        const ResourceState& resource_state {resources[resource]};
+
+        if(resource_state.image)
+        {
+            barrier_batch.useImage(
+                *resource_state.state, resource_state.image, resource_state.aspect_mask, usage
+            );
+        }
+        else
+        {
+            barrier_batch.useBuffer(*resource_state.state, resource_state.buffer, usage);
+        }
+    }
+
+    void RenderGraph::execute(const VkCommandBuffer command_buffer)
+    {
+        statistics = {};
+
+        statistics.pass_count = passes.size();
+
+        const std::size_t previous_flushes {barrier_batch.getFlushCount()};
+        const std::size_t previous_image_barriers {barrier_batch.getImageBarrierCount()};
+        const std::size_t previous_buffer_barriers {barrier_batch.getBufferBarrierCount()};
+
+        cullPasses();
+
+        for(auto& pass : passes)
+        {
+            if(pass.culled)
+            {
+                ++statistics.culled_pass_count;
+
+                continue;
+            }
+
+            for(const auto& access : pass.accesses)
+            {
+                use(access.resource, access.usage);
+            }
+
+            barrier_batch.flush(command_buffer);
+
+            pass.record(command_buffer);
+        }
+
+        for(ResourceHandle resource {}; resource < resources.size(); ++resource)
+        {
+            if(resources[resource].final_usage)
+            {
+                use(resource, *resources[resource].final_usage);
+            }
+        }
+
+        barrier_batch.flush(command_buffer);
+
+        statistics.barrier_batch_count = barrier_batch.getFlushCount() - previous_flushes;
+        statistics.image_barrier_count = barrier_batch.getImageBarrierCount() - previous_image_barriers;
+        statistics.buffer_barrier_count = barrier_batch.getBufferBarrierCount() - previous_buffer_barriers;
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "barrier_batch.hpp"
+#include "resource_usage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    // Rebuilt every frame: import resources, add passes in submission order, mark outputs, execute
+    class RenderGraph
+    {
+        public:
+            using ResourceHandle = std::uint32_t;
+
+            struct Access
+            {
+                ResourceHandle resource;
+
+                ResourceUsage usage;
+            };
+
+            struct GraphStatistics
+            {
+                std::size_t pass_count;
+                std::size_t culled_pass_count;
+
+                std::size_t barrier_batch_count;
+                std::size_t image_barrier_count;
+                std::size_t buffer_barrier_count;
+            };
+
+            RenderGraph() = default;
+
+            RenderGraph(const RenderGraph&) = delete;
+            RenderGraph& operator=(const RenderGraph&) = delete;
+
+            void reset();
+
+            // The state is updated in place, so tracked images carry it into the next frame
+            ResourceHandle importImage(
+                const VkImage image,
+                const VkImageAspectFlags aspect_mask,
+                AccessState& state
+            );
+
+            // For images not tracked across frames. Initial stages are those of an earlier
+            // dependency, such as a semaphore wait, that the first barrier must chain on
+            ResourceHandle importImage(
+                const VkImage image,
+                const VkImageAspectFlags aspect_mask,
+                const VkImageLayout initial_layout,
+                const VkPipelineStageFlags2 initial_stages
+            );
+
+            ResourceHandle importBuffer(const VkBuffer buffer);
+
+            // For buffers written in one frame and read in the next, the state is updated in place
+            ResourceHandle importBuffer(const VkBuffer buffer, AccessState& state);
+
+            void addPass(
+                const std::string_view name,
+                const std::initializer_list<Access> accesses,
+                std::function<void(const VkCommandBuffer command_buffer)>&& record
+            );
+
+            // Passes that do not contribute to an output are culled
+            void setOutput(const ResourceHandle resource, const ResourceUsage final_usage);
+
+            void execute(const VkCommandBuffer command_buffer);
+
+            const GraphStatistics& getStatistics() const;
+
+        private:
+            struct ResourceState
+            {
+                VkImage image;
+                VkBuffer buffer;
+
+                VkImageAspectFlags aspect_mask;
+
+                AccessState* state;
+
+                std::optional<ResourceUsage> final_usage;
+            };
+
+            struct Pass
+            {
+                std::string_view name;
+
+                std::vector<Access> accesses;
+
+                std::function<void(const VkCommandBuffer command_buffer)> record;
+
+                bool culled;
+            };
+
+            std::vector<ResourceState> resources;
+            std::vector<Pass> passes;
+
+            // States of resources imported without one, a deque keeps them in place
+            std::deque<AccessState> owned_states;
+
+            BarrierBatch barrier_batch;
+
+            GraphStatistics statistics {};
+
+            void cullPasses();
+
+            void use(const ResourceHandle resource, const ResourceUsage usage);
+    };
+}
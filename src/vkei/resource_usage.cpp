@@ -0,0 +1,114 @@
+#include "resource_usage.hpp"
+
+namespace mdsm::vkei
+{
+    ResourceUsageInfo getResourceUsageInfo(const ResourceUsage usage)
+    {
+        switch(usage)
+        {
+            case ResourceUsage::ColorAttachment:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    .access_mask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                    .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    .writes = true
+                };
+
+            case ResourceUsage::DepthAttachment:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    .access_mask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                        | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    .layout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                    .writes = true
+                };
+
+            case ResourceUsage::StorageImageWrite:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .access_mask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    .layout = VK_IMAGE_LAYOUT_GENERAL,
+                    .writes = true
+                };
+
+            case ResourceUsage::StorageBufferWrite:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .access_mask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    .layout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .writes = true
+                };
+
+            // Compute reads and vertex fetches through a buffer address
+            case ResourceUsage::StorageBufferRead:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                    .access_mask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                    .layout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .writes = false
+                };
+
+            case ResourceUsage::SampledRead:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+                        | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    .access_mask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                    .layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    .writes = false
+                };
+
+            case ResourceUsage::IndirectRead:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                    .access_mask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                    .layout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .writes = false
+                };
+
+            case ResourceUsage::TransferSource:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                    .access_mask = VK_ACCESS_2_TRANSFER_READ_BIT,
+                    .layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    .writes = false
+                };
+
+            case ResourceUsage::TransferDestination:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                    .access_mask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    .layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .writes = true
+                };
+
+            case ResourceUsage::HostRead:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_HOST_BIT,
+                    .access_mask = VK_ACCESS_2_HOST_READ_BIT,
+                    .layout = VK_IMAGE_LAYOUT_GENERAL,
+                    .writes = false
+                };
+
+            // Visibility for the presentation engine comes from the semaphore, which must be
+            // signalled at these stages so the transition is in its first synchronization scope
+            case ResourceUsage::Present:
+                return ResourceUsageInfo{
+                    .stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                    .access_mask = VK_ACCESS_2_NONE,
+                    .layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                    .writes = false
+                };
+
+            case ResourceUsage::Undefined:
+                break;
+        }
+
+        return ResourceUsageInfo{
+            .stage_mask = VK_PIPELINE_STAGE_2_NONE,
+            .access_mask = VK_ACCESS_2_NONE,
+            .layout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .writes = false
+        };
+    }
+}
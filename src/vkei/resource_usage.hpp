@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    enum class ResourceUsage : std::uint8_t
+    {
+        Undefined,
+        ColorAttachment,
+        DepthAttachment,
+        StorageImageWrite,
+        StorageBufferWrite,
+        StorageBufferRead,
+        SampledRead,
+        IndirectRead,
+        TransferSource,
+        TransferDestination,
+        HostRead,
+        Present
+    };
+
+    struct ResourceUsageInfo
+    {
+        VkPipelineStageFlags2 stage_mask;
+        VkAccessFlags2 access_mask;
+
+        // Ignored for buffers
+        VkImageLayout layout;
+
+        bool writes;
+    };
+
+    ResourceUsageInfo getResourceUsageInfo(const ResourceUsage usage);
+}
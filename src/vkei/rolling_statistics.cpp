@@ -0,0 +1,63 @@
+#include "rolling_statistics.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace mdsm::vkei
+{
+    RollingStatistics::RollingStatistics(const std::size_t window_size)
+    :
+        samples (std::max<std::size_t>(window_size, 1))
+    {
+    }
+
+    void RollingStatistics::addSample(const double sample)
+    {
+        samples[next_sample] = sample;
+
+        next_sample = (next_sample + 1) % samples.size();
+
+        sample_count = std::min(sample_count + 1, samples.size());
+    }
+
+    void RollingStatistics::clear()
+    {
+        next_sample = 0;
+        sample_count = 0;
+    }
+
+    double RollingStatistics::getAverage() const
+    {
+        if(sample_count == 0)
+        {
+            return 0.0;
+        }
+
+        return std::accumulate(samples.begin(), samples.begin() + sample_count, 0.0) / sample_count;
+    }
+
+    double RollingStatistics::getMaximum() const
+    {
+        if(sample_count == 0)
+        {
+            return 0.0;
+        }
+
+        return *std::max_element(samples.begin(), samples.begin() + sample_count);
+    }
+
+    double RollingStatistics::getLatest() const
+    {
+        if(sample_count == 0)
+        {
+            return 0.0;
+        }
+
+        return samples[(next_sample + samples.size() - 1) % samples.size()];
+    }
+
+    std::size_t RollingStatistics::getSampleCount() const
+    {
+        return sample_count;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace mdsm::vkei
+{
+    class RollingStatistics
+    {
+        public:
+            explicit RollingStatistics(const std::size_t window_size = 128);
+
+            void addSample(const double sample);
+
+            void clear();
+
+            double getAverage() const;
+            double getMaximum() const;
+            double getLatest() const;
+
+            std::size_t getSampleCount() const;
+
+        private:
+            std::vector<double> samples;
+
+            std::size_t next_sample {};
+            std::size_t sample_count {};
+    };
+}
@@ -0,0 +1,78 @@
+#include "staging_ring.hpp"
+
+#include <algorithm>
+
+namespace mdsm::vkei
+{
+    void StagingRing::initialize(
+        const VkBuffer buffer,
+        void* const mapped_data,
+        const VkDeviceSize capacity
+    )
+    {
+        this->buffer = buffer;
+        this->mapped_data = static_cast<std::byte*>(mapped_data);
+        this->capacity = capacity;
+
+        head = 0;
+        used = 0;
+    }
+
+    std::optional<StagingRing::Allocation> StagingRing::allocate(
+        const VkDeviceSize size, const VkDeviceSize alignment
+    )
+    {
+        const VkDeviceSize effective_alignment {
+            std::max<VkDeviceSize>(alignment, 1)
+        };
+
+        VkDeviceSize offset {
+            (head + effective_alignment - 1) / effective_alignment * effective_alignment
+        };
+
+        VkDeviceSize footprint {offset - head + size};
+
+        // Wrap around, the skipped tail space stays in use until this allocation is released
+        if(offset + size > capacity)
+        {
+            offset = 0;
+            footprint = capacity - head + size;
+        }
+
+        if(used + footprint > capacity)
+        {
+            return std::nullopt;
+        }
+
+        head = offset + size;
+        used += footprint;
+
+        return Allocation{
+            .buffer = buffer,
+            .offset = offset,
+            .data = mapped_data + offset,
+            .footprint = footprint
+        };
+    }
+
+    void StagingRing::release(const VkDeviceSize footprint)
+    {
+        used -= footprint;
+
+        // Restart from the beginning once drained to keep large requests contiguous
+        if(used == 0)
+        {
+            head = 0;
+        }
+    }
+
+    VkDeviceSize StagingRing::getUsedSize() const
+    {
+        return used;
+    }
+
+    VkDeviceSize StagingRing::getCapacity() const
+    {
+        return capacity;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    class StagingRing
+    {
+        public:
+            struct Allocation
+            {
+                VkBuffer buffer;
+                VkDeviceSize offset;
+
+                std::byte* data;
+
+                // Bytes consumed from the ring, including alignment padding and skipped tail space
+                VkDeviceSize footprint;
+            };
+
+            StagingRing() = default;
+
+            StagingRing(const StagingRing&) = delete;
+            StagingRing& operator=(const StagingRing&) = delete;
+
+            void initialize(
+                const VkBuffer buffer,
+                void* const mapped_data,
+                const VkDeviceSize capacity
+            );
+
+            // Returns nothing if the request does not fit until older footprints are released
+            std::optional<Allocation> allocate(const VkDeviceSize size, const VkDeviceSize alignment = 1);
+
+            // Footprints must be released in allocation order
+            void release(const VkDeviceSize footprint);
+
+            VkDeviceSize getUsedSize() const;
+            VkDeviceSize getCapacity() const;
+
+        private:
+            VkBuffer buffer {};
+
+            std::byte* mapped_data {};
+
+            VkDeviceSize capacity {};
+
+            VkDeviceSize head {};
+            VkDeviceSize used {};
+    };
+}
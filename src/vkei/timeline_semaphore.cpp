@@ -0,0 +1,128 @@
+#include "timeline_semaphore.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    void TimelineSemaphore::initialize(const VkDevice device, const std::uint64_t initial_value)
+    {
+        VkSemaphoreTypeCreateInfo type_info {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue = initial_value;
+
+        VkSemaphoreCreateInfo semaphore_info {generateSemaphoreCreateInfo()};
+
+        semaphore_info.pNext = &type_info;
+
+        check(
+            vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore)
+        );
+
+        last_reserved_value = initial_value;
+        completed_value = initial_value;
+    }
+
+    void TimelineSemaphore::destroy(const VkDevice device)
+    {
+        vkDestroySemaphore(device, semaphore, nullptr);
+
+        semaphore = VK_NULL_HANDLE;
+    }
+
+    std::uint64_t TimelineSemaphore::reserveValue()
+    {
+        return ++last_reserved_value;
+    }
+
+    std::uint64_t TimelineSemaphore::getLastReservedValue() const
+    {
+        return last_reserved_value;
+    }
+
+    std::uint64_t TimelineSemaphore::getCompletedValue(const VkDevice device) const
+    {
+        std::uint64_t value;
+
+        check(
+            vkGetSemaphoreCounterValue(device, semaphore, &value)
+        );
+
+        completed_value = std::max(completed_value, value);
+
+        return completed_value;
+    }
+
+    bool TimelineSemaphore::isComplete(const VkDevice device, const std::uint64_t value) const
+    {
+        if(value <= completed_value)
+        {
+            return true;
+        }
+
+        return getCompletedValue(device) >= value;
+    }
+
+    bool TimelineSemaphore::wait(
+        const VkDevice device,
+        const std::uint64_t value,
+        const std::uint64_t timeout
+    ) const
+    {
+        if(value <= completed_value)
+        {
+            return true;
+        }
+
+        VkSemaphoreWaitInfo wait_info {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr
+        };
+
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &semaphore;
+        wait_info.pValues = &value;
+
+        const VkResult result {
+            vkWaitSemaphores(device, &wait_info, timeout)
+        };
+
+        if(result == VK_TIMEOUT)
+        {
+            return false;
+        }
+
+        check(result);
+
+        completed_value = std::max(completed_value, value);
+
+        return true;
+    }
+
+    VkSemaphoreSubmitInfo TimelineSemaphore::generateSignalInfo(
+        const std::uint64_t value,
+        const VkPipelineStageFlags2 stage_mask
+    ) const
+    {
+        return generateSemaphoreSubmitInfo(stage_mask, semaphore, value);
+    }
+
+    VkSemaphoreSubmitInfo TimelineSemaphore::generateWaitInfo(
+        const std::uint64_t value,
+        const VkPipelineStageFlags2 stage_mask
+    ) const
+    {
+        return generateSemaphoreSubmitInfo(stage_mask, semaphore, value);
+    }
+
+    TimelineSemaphore::operator VkSemaphore() const
+    {
+        return semaphore;
+    }
+}
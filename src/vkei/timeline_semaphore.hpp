@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    class TimelineSemaphore
+    {
+        public:
+            TimelineSemaphore() = default;
+
+            TimelineSemaphore(const TimelineSemaphore&) = delete;
+            TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+
+            void initialize(const VkDevice device, const std::uint64_t initial_value = 0);
+
+            void destroy(const VkDevice device);
+
+            std::uint64_t reserveValue();
+
+            std::uint64_t getLastReservedValue() const;
+
+            std::uint64_t getCompletedValue(const VkDevice device) const;
+
+            bool isComplete(const VkDevice device, const std::uint64_t value) const;
+
+            // Returns false if the timeout expired before the value was reached
+            bool wait(
+                const VkDevice device,
+                const std::uint64_t value,
+                const std::uint64_t timeout
+            ) const;
+
+            VkSemaphoreSubmitInfo generateSignalInfo(
+                const std::uint64_t value,
+                const VkPipelineStageFlags2 stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+            ) const;
+
+            VkSemaphoreSubmitInfo generateWaitInfo(
+                const std::uint64_t value,
+                const VkPipelineStageFlags2 stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+            ) const;
+
+            operator VkSemaphore() const;
+
+        private:
+            VkSemaphore semaphore {};
+
+            std::uint64_t last_reserved_value {};
+
+            mutable std::uint64_t completed_value {};
+    };
+}
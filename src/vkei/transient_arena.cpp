@@ -0,0 +1,79 @@
+#include "transient_arena.hpp"
+
+#include <algorithm>
+#include <format>
+
+namespace mdsm::vkei
+{
+    TransientArena::ArenaExhausted::ArenaExhausted(
+        const VkDeviceSize requested, const VkDeviceSize available
+    )
+    :
+        runtime_error {
+            std::format(
+                "Transient arena exhausted ({} bytes requested, {} bytes available)!",
+                requested,
+                available
+            )
+        },
+        requested {requested},
+        available {available}
+    {
+    }
+
+    void TransientArena::initialize(
+        const VkBuffer buffer,
+        void* const mapped_data,
+        const VkDeviceSize capacity,
+        const VkDeviceSize min_alignment
+    )
+    {
+        this->buffer = buffer;
+        this->mapped_data = static_cast<std::byte*>(mapped_data);
+        this->capacity = capacity;
+        this->min_alignment = std::max<VkDeviceSize>(min_alignment, 1);
+
+        head = 0;
+    }
+
+    TransientArena::Allocation TransientArena::allocate(
+        const VkDeviceSize size, const VkDeviceSize alignment
+    )
+    {
+        const VkDeviceSize effective_alignment {
+            std::max(alignment, min_alignment)
+        };
+
+        const VkDeviceSize offset {
+            (head + effective_alignment - 1) / effective_alignment * effective_alignment
+        };
+
+        if(offset + size > capacity)
+        {
+            throw ArenaExhausted{size, capacity - std::min(offset, capacity)};
+        }
+
+        head = offset + size;
+
+        return Allocation{
+            .buffer = buffer,
+            .offset = offset,
+            .data = mapped_data + offset
+        };
+    }
+
+    void TransientArena::reset()
+    {
+        head = 0;
+    }
+
+    VkDeviceSize TransientArena::getUsedSize() const
+    {
+        return head;
+    }
+
+    VkDeviceSize TransientArena::getCapacity() const
+    {
+        return capacity;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    class TransientArena
+    {
+        public:
+            struct Allocation
+            {
+                VkBuffer buffer;
+                VkDeviceSize offset;
+
+                void* data;
+            };
+
+            class ArenaExhausted : public std::runtime_error
+            {
+                public:
+                    ArenaExhausted(const VkDeviceSize requested, const VkDeviceSize available);
+
+                    const VkDeviceSize requested;
+                    const VkDeviceSize available;
+            };
+
+            TransientArena() = default;
+
+            TransientArena(const TransientArena&) = delete;
+            TransientArena& operator=(const TransientArena&) = delete;
+
+            void initialize(
+                const VkBuffer buffer,
+                void* const mapped_data,
+                const VkDeviceSize capacity,
+                const VkDeviceSize min_alignment
+            );
+
+            Allocation allocate(const VkDeviceSize size, const VkDeviceSize alignment = 0);
+
+            void reset();
+
+            VkDeviceSize getUsedSize() const;
+            VkDeviceSize getCapacity() const;
+
+        private:
+            VkBuffer buffer {};
+
+            std::byte* mapped_data {};
+
+            VkDeviceSize capacity {};
+            VkDeviceSize min_alignment {1};
+            VkDeviceSize head {};
+    };
+}
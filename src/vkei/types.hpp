@@ -9,12 +9,17 @@
 #include <vulkan/vulkan_core.h>
 #include <glm/glm.hpp>
 #include "descriptor_allocator.hpp"
+#include "descriptor_buffer.hpp"
+#include "descriptor_set_cache.hpp"
+#include "gpu_profiler.hpp"
 #include "vk_mem_alloc.h"
 #include "resource_cleaner.hpp"
+#include "transient_arena.hpp"
 
 namespace mdsm::vkei
 {
     class Engine;
+    class GeometryPool;
 
     class VulkanException : public std::runtime_error
     {
@@ -53,16 +58,38 @@ namespace mdsm::vkei
     struct MaterialPipeline
     {
         VkPipeline pipeline;
+
+        // Same layout, reads the transform and vertex buffer of an indirect draw from the object buffer
+        VkPipeline indirect_pipeline;
+
         VkPipelineLayout layout;
     };
 
+    // A descriptor set, or the offset of its descriptors when descriptors live in descriptor buffers
+    struct DescriptorBinding
+    {
+        VkDescriptorSet set;
+        VkDeviceSize offset;
+
+        bool operator==(const DescriptorBinding&) const = default;
+    };
+
     struct MaterialInstance
     {
         MaterialPipeline* pipeline;
         
         VkDescriptorSet descriptor_set;
 
+        // Offset in the material descriptor buffer, used instead of descriptor_set with descriptor buffers
+        VkDeviceSize descriptor_offset {};
+
         MaterialPass pass_type;
+
+        // Entry in the bindless table, unused when every material binds its own set
+        std::uint32_t material_index {};
+
+        // Upload ticket of the newest image the material samples
+        std::uint64_t upload_ticket {};
     };
 
     struct Material
@@ -70,23 +97,40 @@ namespace mdsm::vkei
         MaterialInstance data;
     };
 
+    // Object-space box and enclosing sphere, both centered on origin
+    struct Bounds
+    {
+        glm::vec3 origin;
+        float sphere_radius;
+
+        glm::vec3 extents;
+    };
+
+    // Geometry lives in the engine's GeometryPool, offsets are in elements
     struct RenderObject
     {
         std::uint32_t index_count;
         std::uint32_t first_index;
-
-        VkBuffer index_buffer;
+        std::int32_t vertex_offset;
 
         MaterialInstance* material;
 
         glm::mat4 transform;
 
-        VkDeviceAddress vertex_buffer_address;
+        Bounds bounds;
+
+        std::uint64_t upload_ticket {};
     };
 
     struct DrawContext
     {
         std::vector<RenderObject> opaque_surfaces;
+
+        // Drawn after every opaque surface, back to front
+        std::vector<RenderObject> transparent_surfaces;
+
+        // Mesh ranges are looked up here, they move whenever the pool relocates
+        const GeometryPool* geometry_pool {};
     };
  
     struct SceneData
@@ -107,42 +151,85 @@ namespace mdsm::vkei
         VmaAllocation allocation;
         VkExtent3D image_extent;
         VkFormat image_format;
+
+        std::uint64_t upload_ticket {};
+    };
+    
+    struct AllocatedBuffer 
+    {
+        VkBuffer buffer;
+    
+        VmaAllocation allocation;
+        VmaAllocationInfo allocation_info;
     };
     
     struct FrameData
     {
         VkCommandPool command_pool;
         VkCommandBuffer main_command_buffer;
+
+        // One pool per recording chunk, reset as a whole at the start of the frame
+        std::vector<VkCommandPool> recording_pools;
+        std::vector<VkCommandBuffer> recording_command_buffers;
+
+        // From the first recording pool, recorded by the calling thread after its opaque chunk
+        VkCommandBuffer transparent_command_buffer;
     
         VkSemaphore swapchain_semaphore;
         VkSemaphore render_semaphore;
     
-        VkFence render_fence;
+        // Graphics timeline value signalled by this frame's last submission
+        std::uint64_t timeline_value {};
     
         ResourceCleaner resource_cleaner;
     
         DescriptorAllocator frame_descriptors;
+
+        // Sets of frame_descriptors, both are reset together every few uses of the frame
+        DescriptorSetCache descriptor_cache;
+        std::size_t descriptor_cache_frames {};
+
+        // Replaces frame_descriptors with descriptor buffers, reset once the frame is done
+        DescriptorBuffer descriptor_buffer;
+
+        AllocatedBuffer readback_buffer;
+
+        FrameTimestamps timestamps;
+
+        AllocatedBuffer transient_buffer;
+        TransientArena transient_arena;
+
+        // One transform per drawn instance, grown on demand
+        AllocatedBuffer instance_buffer;
+        VkDeviceAddress instance_buffer_address {};
+
+        std::size_t instance_capacity {};
+
+        // GPU-driven path, written by the cull pass and only ever grown
+        AllocatedBuffer draw_command_buffer;
+        AllocatedBuffer draw_count_buffer;
+
+        std::size_t gpu_command_capacity {};
+        std::size_t gpu_batch_capacity {};
     };
     
-    struct AllocatedBuffer 
-    {
-        VkBuffer buffer;
-    
-        VmaAllocation allocation;
-        VmaAllocationInfo allocation_info;
-    };
-    
+    // Offsets are resolved through the geometry pool each time the mesh is drawn
     struct MeshBuffers
     {
-        AllocatedBuffer index_buffer;
-        AllocatedBuffer vertex_buffer;
-        VkDeviceAddress vertex_buffer_address;
+        std::uint32_t geometry_handle;
+
+        std::uint64_t upload_ticket {};
     };
     
+    // Per-draw data is read at gl_InstanceIndex, from the instance transforms or the GPU object buffer
     struct DrawPushCostants 
     {
-        glm::mat4 world_matrix;
         VkDeviceAddress vertex_buffer;
+        VkDeviceAddress instance_buffer;
+
+        // Only read by the bindless shaders
+        std::uint32_t material_index;
+        std::uint32_t padding;
     };
 
     struct Surface 
@@ -150,6 +237,8 @@ namespace mdsm::vkei
         std::uint32_t start_index;
         std::uint32_t count;
 
+        Bounds bounds;
+
         std::shared_ptr<Material> material;
     };
 
@@ -0,0 +1,683 @@
+#include "upload_service.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ranges>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    namespace
+    {
+        void recordBarriers(
+            const VkCommandBuffer command_buffer,
+            const std::span<const VkBufferMemoryBarrier2> buffer_barriers,
+            const std::span<const VkImageMemoryBarrier2> image_barriers
+        )
+        {
+            VkDependencyInfo dependency_info {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr
+            };
+
+            dependency_info.bufferMemoryBarrierCount = static_cast<std::uint32_t>(buffer_barriers.size());
+            dependency_info.pBufferMemoryBarriers = buffer_barriers.data();
+            dependency_info.imageMemoryBarrierCount = static_cast<std::uint32_t>(image_barriers.size());
+            dependency_info.pImageMemoryBarriers = image_barriers.data();
+
+            vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        }
+    }
+
+    double UploadService::UploadStatistics::getThroughput() const
+    {
+        if(transfer_time.count() == 0)
+        {
+            return 0.0;
+        }
+
+        return static_cast<double>(uploaded_bytes) / 1e6
+            / std::chrono::duration<double>(transfer_time).count();
+    }
+
+    void UploadService::initialize(
+        const VkDevice device,
+        const VmaAllocator allocator,
+        const VkQueue graphics_queue,
+        const std::uint32_t graphics_queue_family,
+        const VkQueue transfer_queue,
+        const std::uint32_t transfer_queue_family,
+        const VkDeviceSize staging_capacity,
+        JobSystem& job_system
+    )
+    {
+        this->device = device;
+        this->allocator = allocator;
+        this->job_system = &job_system;
+        this->graphics_queue = graphics_queue;
+        this->graphics_queue_family = graphics_queue_family;
+        this->transfer_queue = transfer_queue;
+        this->transfer_queue_family = transfer_queue_family;
+
+        VkCommandPoolCreateInfo transfer_pool_info {
+            generateCommandPoolCreateInfo(transfer_queue_family)
+        };
+
+        check(
+            vkCreateCommandPool(device, &transfer_pool_info, nullptr, &transfer_command_pool)
+        );
+
+        if(usesDedicatedTransferQueue())
+        {
+            VkCommandPoolCreateInfo acquire_pool_info {
+                generateCommandPoolCreateInfo(graphics_queue_family)
+            };
+
+            check(
+                vkCreateCommandPool(device, &acquire_pool_info, nullptr, &acquire_command_pool)
+            );
+        }
+
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = staging_capacity;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VmaAllocationCreateInfo allocation_info {};
+
+        allocation_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+        allocation_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo staging_info;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &buffer_info,
+                &allocation_info,
+                &staging_buffer,
+                &staging_allocation,
+                &staging_info
+            )
+        );
+
+        staging_ring.initialize(staging_buffer, staging_info.pMappedData, staging_capacity);
+
+        transfer_timeline.initialize(device);
+        acquire_timeline.initialize(device);
+    }
+
+    void UploadService::destroy()
+    {
+        for(const auto& batch : batches)
+        {
+            for(const auto& staging : batch.dedicated_staging)
+            {
+                vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+            }
+        }
+
+        batches.clear();
+        acquire_submissions.clear();
+
+        vmaDestroyBuffer(allocator, staging_buffer, staging_allocation);
+
+        vkDestroyCommandPool(device, transfer_command_pool, nullptr);
+
+        if(acquire_command_pool)
+        {
+            vkDestroyCommandPool(device, acquire_command_pool, nullptr);
+        }
+
+        transfer_timeline.destroy(device);
+        acquire_timeline.destroy(device);
+    }
+
+    bool UploadService::usesDedicatedTransferQueue() const
+    {
+        return transfer_queue_family != graphics_queue_family;
+    }
+
+    const UploadService::UploadStatistics& UploadService::getStatistics() const
+    {
+        return statistics;
+    }
+
+    UploadService::UploadBatch& UploadService::getRecordingBatch()
+    {
+        if(!batches.empty() && batches.back().state == BatchState::Recording)
+        {
+            return batches.back();
+        }
+
+        UploadBatch batch {};
+
+        batch.state = BatchState::Recording;
+
+        // Batches are submitted in the order they are opened, so the value can be reserved up front
+        batch.ticket = transfer_timeline.reserveValue();
+
+        VkCommandBufferAllocateInfo command_buffer_info {
+            generateCommandBufferAllocateInfo(transfer_command_pool, 1)
+        };
+
+        check(
+            vkAllocateCommandBuffers(device, &command_buffer_info, &batch.transfer_command_buffer)
+        );
+
+        VkCommandBufferBeginInfo begin_info {
+            generateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)
+        };
+
+        check(
+            vkBeginCommandBuffer(batch.transfer_command_buffer, &begin_info)
+        );
+
+        return batches.emplace_back(std::move(batch));
+    }
+
+    UploadService::StagingSpace UploadService::allocateStaging(const VkDeviceSize size)
+    {
+        while(size <= staging_ring.getCapacity())
+        {
+            if(const auto allocation {staging_ring.allocate(size, staging_alignment)})
+            {
+                getRecordingBatch().ring_footprint += allocation->footprint;
+
+                return StagingSpace{
+                    .buffer = allocation->buffer,
+                    .offset = allocation->offset,
+                    .data = allocation->data
+                };
+            }
+
+            const auto oldest_transfer {
+                std::ranges::find(batches, BatchState::Transferring, &UploadBatch::state)
+            };
+
+            if(oldest_transfer != batches.end())
+            {
+                transfer_timeline.wait(device, oldest_transfer->ticket, UINT64_MAX);
+
+                retireTransfers();
+            }
+            else if(!batches.empty() && batches.back().state == BatchState::Recording)
+            {
+                flush();
+            }
+            else 
+            {
+                break;
+            }
+        }
+
+        DedicatedStaging staging;
+
+        VkBufferCreateInfo buffer_info {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr
+        };
+
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VmaAllocationCreateInfo allocation_info {};
+
+        allocation_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+        allocation_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo staging_info;
+
+        check(
+            vmaCreateBuffer(
+                allocator,
+                &buffer_info,
+                &allocation_info,
+                &staging.buffer,
+                &staging.allocation,
+                &staging_info
+            )
+        );
+
+        getRecordingBatch().dedicated_staging.push_back(staging);
+
+        ++statistics.dedicated_staging_count;
+
+        return StagingSpace{
+            .buffer = staging.buffer,
+            .offset = 0,
+            .data = static_cast<std::byte*>(staging_info.pMappedData)
+        };
+    }
+
+    void UploadService::copyToStaging(
+        std::byte* const destination, const void* const source, const VkDeviceSize size
+    )
+    {
+        if(size < 2 * parallel_copy_block_size)
+        {
+            std::memcpy(destination, source, size);
+
+            return;
+        }
+
+        job_system->parallelFor(
+            size,
+            parallel_copy_block_size,
+            [&](const std::size_t begin, const std::size_t end)
+            {
+                std::memcpy(destination + begin, static_cast<const std::byte*>(source) + begin, end - begin);
+            }
+        );
+    }
+
+    void UploadService::addBufferRelease(UploadBatch& batch, VkBufferMemoryBarrier2 release)
+    {
+        if(usesDedicatedTransferQueue())
+        {
+            release.srcQueueFamilyIndex = transfer_queue_family;
+            release.dstQueueFamilyIndex = graphics_queue_family;
+
+            VkBufferMemoryBarrier2 acquire {release};
+
+            acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+            acquire.srcAccessMask = VK_ACCESS_2_NONE;
+            acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+
+            batch.buffer_acquires.push_back(acquire);
+        }
+        else
+        {
+            release.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            release.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        }
+
+        batch.buffer_releases.push_back(release);
+    }
+
+    void UploadService::addImageRelease(UploadBatch& batch, VkImageMemoryBarrier2 release)
+    {
+        if(usesDedicatedTransferQueue())
+        {
+            release.srcQueueFamilyIndex = transfer_queue_family;
+            release.dstQueueFamilyIndex = graphics_queue_family;
+
+            VkImageMemoryBarrier2 acquire {release};
+
+            acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+            acquire.srcAccessMask = VK_ACCESS_2_NONE;
+            acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            acquire.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+
+            batch.image_acquires.push_back(acquire);
+        }
+        else
+        {
+            release.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            release.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+        }
+
+        batch.image_releases.push_back(release);
+    }
+
+    std::uint64_t UploadService::uploadBuffers(const std::span<const BufferUpload> uploads)
+    {
+        VkDeviceSize staging_size {};
+
+        for(const auto& buffer_upload : uploads)
+        {
+            staging_size += buffer_upload.size;
+        }
+
+        const StagingSpace staging {allocateStaging(staging_size)};
+
+        UploadBatch& batch {getRecordingBatch()};
+
+        VkDeviceSize staging_offset {};
+
+        for(const auto& buffer_upload : uploads)
+        {
+            copyToStaging(staging.data + staging_offset, buffer_upload.data, buffer_upload.size);
+
+            VkBufferCopy copy {};
+
+            copy.srcOffset = staging.offset + staging_offset;
+            copy.dstOffset = buffer_upload.destination_offset;
+            copy.size = buffer_upload.size;
+
+            vkCmdCopyBuffer(
+                batch.transfer_command_buffer,
+                staging.buffer,
+                buffer_upload.destination,
+                1,
+                &copy
+            );
+
+            VkBufferMemoryBarrier2 release {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .pNext = nullptr
+            };
+
+            release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            release.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            release.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            release.buffer = buffer_upload.destination;
+            release.offset = buffer_upload.destination_offset;
+            release.size = buffer_upload.size;
+
+            addBufferRelease(batch, release);
+
+            staging_offset += buffer_upload.size;
+        }
+
+        batch.uploaded_bytes += staging_size;
+
+        statistics.upload_count += uploads.size();
+
+        return batch.ticket;
+    }
+
+    std::uint64_t UploadService::uploadImage(
+        const VkImage image,
+        const VkExtent3D extent,
+        const void* const data,
+        const VkDeviceSize size
+    )
+    {
+        const StagingSpace staging {allocateStaging(size)};
+
+        UploadBatch& batch {getRecordingBatch()};
+
+        copyToStaging(staging.data, data, size);
+
+        VkImageMemoryBarrier2 to_transfer {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr
+        };
+
+        to_transfer.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        to_transfer.srcAccessMask = VK_ACCESS_2_NONE;
+        to_transfer.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        to_transfer.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        to_transfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        to_transfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_transfer.image = image;
+        to_transfer.subresourceRange = generateImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT);
+
+        recordBarriers(batch.transfer_command_buffer, {}, std::span{&to_transfer, 1});
+
+        VkBufferImageCopy copy_region {};
+
+        copy_region.bufferOffset = staging.offset;
+        copy_region.bufferRowLength = 0;
+        copy_region.bufferImageHeight = 0;
+
+        copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy_region.imageSubresource.mipLevel = 0;
+        copy_region.imageSubresource.baseArrayLayer = 0;
+        copy_region.imageSubresource.layerCount = 1;
+        copy_region.imageExtent = extent;
+
+        vkCmdCopyBufferToImage(
+            batch.transfer_command_buffer,
+            staging.buffer,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1,
+            &copy_region
+        );
+
+        VkImageMemoryBarrier2 release {to_transfer};
+
+        release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        release.dstAccessMask = VK_ACCESS_2_NONE;
+        release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        release.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        addImageRelease(batch, release);
+
+        batch.uploaded_bytes += size;
+
+        ++statistics.upload_count;
+
+        return batch.ticket;
+    }
+
+    void UploadService::flush()
+    {
+        if(batches.empty() || batches.back().state != BatchState::Recording)
+        {
+            return;
+        }
+
+        UploadBatch& batch {batches.back()};
+
+        recordBarriers(batch.transfer_command_buffer, batch.buffer_releases, batch.image_releases);
+
+        check(
+            vkEndCommandBuffer(batch.transfer_command_buffer)
+        );
+
+        VkCommandBufferSubmitInfo command_buffer_info {
+            generateCommandBufferSubmitInfo(batch.transfer_command_buffer)
+        };
+
+        const VkSemaphoreSubmitInfo signal_info {
+            transfer_timeline.generateSignalInfo(batch.ticket)
+        };
+
+        VkSubmitInfo2 submit_info {
+            generateSubmitInfo(&command_buffer_info, &signal_info, nullptr)
+        };
+
+        check(
+            vkQueueSubmit2(transfer_queue, 1, &submit_info, VK_NULL_HANDLE)
+        );
+
+        batch.state = BatchState::Transferring;
+        batch.submit_time = std::chrono::steady_clock::now();
+
+        batch.buffer_releases.clear();
+        batch.image_releases.clear();
+
+        ++statistics.submit_count;
+    }
+
+    bool UploadService::isReady(const std::uint64_t ticket) const
+    {
+        return ticket <= ready_ticket;
+    }
+
+    void UploadService::retireTransfers()
+    {
+        std::vector<UploadBatch*> transferred_batches;
+
+        for(auto& batch : batches)
+        {
+            if(batch.state == BatchState::Acquiring)
+            {
+                continue;
+            }
+
+            if(
+                batch.state == BatchState::Recording
+                ||
+                !transfer_timeline.isComplete(device, batch.ticket)
+            )
+            {
+                break;
+            }
+
+            batch.state = BatchState::Acquiring;
+
+            statistics.uploaded_bytes += batch.uploaded_bytes;
+            statistics.transfer_time += std::chrono::steady_clock::now() - batch.submit_time;
+
+            // The staging data is no longer read once the copies have executed
+            staging_ring.release(batch.ring_footprint);
+
+            for(const auto& staging : batch.dedicated_staging)
+            {
+                vmaDestroyBuffer(allocator, staging.buffer, staging.allocation);
+            }
+
+            batch.dedicated_staging.clear();
+
+            vkFreeCommandBuffers(device, transfer_command_pool, 1, &batch.transfer_command_buffer);
+
+            if(usesDedicatedTransferQueue())
+            {
+                transferred_batches.push_back(&batch);
+            }
+        }
+
+        if(!transferred_batches.empty())
+        {
+            submitAcquires(transferred_batches);
+        }
+    }
+
+    void UploadService::submitAcquires(const std::span<UploadBatch* const> transferred_batches)
+    {
+        std::vector<VkBufferMemoryBarrier2> buffer_acquires;
+        std::vector<VkImageMemoryBarrier2> image_acquires;
+
+        for(const auto* const batch : transferred_batches)
+        {
+            buffer_acquires.insert(
+                buffer_acquires.end(), batch->buffer_acquires.begin(), batch->buffer_acquires.end()
+            );
+
+            image_acquires.insert(
+                image_acquires.end(), batch->image_acquires.begin(), batch->image_acquires.end()
+            );
+        }
+
+        VkCommandBuffer command_buffer;
+
+        VkCommandBufferAllocateInfo command_buffer_info {
+            generateCommandBufferAllocateInfo(acquire_command_pool, 1)
+        };
+
+        check(
+            vkAllocateCommandBuffers(device, &command_buffer_info, &command_buffer)
+        );
+
+        VkCommandBufferBeginInfo begin_info {
+            generateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)
+        };
+
+        check(
+            vkBeginCommandBuffer(command_buffer, &begin_info)
+        );
+
+        recordBarriers(command_buffer, buffer_acquires, image_acquires);
+
+        check(
+            vkEndCommandBuffer(command_buffer)
+        );
+
+        const std::uint64_t acquire_value {acquire_timeline.reserveValue()};
+
+        VkCommandBufferSubmitInfo command_buffer_submit_info {
+            generateCommandBufferSubmitInfo(command_buffer)
+        };
+
+        // Already reached on the host, the wait only orders the release before the acquire
+        const VkSemaphoreSubmitInfo wait_info {
+            transfer_timeline.generateWaitInfo(transferred_batches.back()->ticket)
+        };
+
+        const VkSemaphoreSubmitInfo signal_info {
+            acquire_timeline.generateSignalInfo(acquire_value)
+        };
+
+        VkSubmitInfo2 submit_info {
+            generateSubmitInfo(&command_buffer_submit_info, &signal_info, &wait_info)
+        };
+
+        check(
+            vkQueueSubmit2(graphics_queue, 1, &submit_info, VK_NULL_HANDLE)
+        );
+
+        for(auto* const batch : transferred_batches)
+        {
+            batch->acquire_value = acquire_value;
+
+            batch->buffer_acquires.clear();
+            batch->image_acquires.clear();
+        }
+
+        acquire_submissions.push_back(
+            AcquireSubmission{
+                .value = acquire_value,
+                .command_buffer = command_buffer
+            }
+        );
+    }
+
+    void UploadService::collect()
+    {
+        flush();
+
+        retireTransfers();
+
+        while(
+            !batches.empty()
+            &&
+            batches.front().state == BatchState::Acquiring
+            &&
+            acquire_timeline.isComplete(device, batches.front().acquire_value)
+        )
+        {
+            ready_ticket = batches.front().ticket;
+
+            batches.pop_front();
+        }
+
+        while(
+            !acquire_submissions.empty()
+            &&
+            acquire_timeline.isComplete(device, acquire_submissions.front().value)
+        )
+        {
+            vkFreeCommandBuffers(
+                device, acquire_command_pool, 1, &acquire_submissions.front().command_buffer
+            );
+
+            acquire_submissions.pop_front();
+        }
+    }
+
+    void UploadService::waitIdle()
+    {
+        flush();
+
+        if(!transfer_timeline.wait(device, transfer_timeline.getLastReservedValue(), wait_timeout))
+        {
+            throw VulkanException{VK_TIMEOUT};
+        }
+
+        // Submits the ownership acquires of the finished transfers
+        collect();
+
+        if(!acquire_timeline.wait(device, acquire_timeline.getLastReservedValue(), wait_timeout))
+        {
+            throw VulkanException{VK_TIMEOUT};
+        }
+
+        collect();
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "job_system.hpp"
+#include "staging_ring.hpp"
+#include "timeline_semaphore.hpp"
+#include "vk_mem_alloc.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace mdsm::vkei
+{
+    class UploadService
+    {
+        public:
+            struct BufferUpload
+            {
+                VkBuffer destination;
+                VkDeviceSize destination_offset;
+
+                const void* data;
+                VkDeviceSize size;
+            };
+
+            struct UploadStatistics
+            {
+                std::size_t upload_count;
+                std::size_t submit_count;
+
+                // Uploads too large for the staging ring
+                std::size_t dedicated_staging_count;
+
+                VkDeviceSize uploaded_bytes;
+
+                // Host-observed time from submission until the transfer was seen complete
+                std::chrono::nanoseconds transfer_time;
+
+                double getThroughput() const;
+            };
+
+            UploadService() = default;
+
+            UploadService(const UploadService&) = delete;
+            UploadService& operator=(const UploadService&) = delete;
+
+            void initialize(
+                const VkDevice device,
+                const VmaAllocator allocator,
+                const VkQueue graphics_queue,
+                const std::uint32_t graphics_queue_family,
+                const VkQueue transfer_queue,
+                const std::uint32_t transfer_queue_family,
+                const VkDeviceSize staging_capacity,
+                JobSystem& job_system
+            );
+
+            void destroy();
+
+            // Uploads are recorded into the open batch, tickets become ready once
+            // the batch has been flushed and its data is visible to the graphics queue
+            std::uint64_t uploadBuffers(const std::span<const BufferUpload> uploads);
+
+            std::uint64_t uploadImage(
+                const VkImage image,
+                const VkExtent3D extent,
+                const void* const data,
+                const VkDeviceSize size
+            );
+
+            // Submits the open batch with a single transfer submission
+            void flush();
+
+            bool isReady(const std::uint64_t ticket) const;
+
+            // Flushes, hands finished transfers over to the graphics queue and recycles staging memory
+            void collect();
+
+            // Blocks until every upload so far is ready
+            void waitIdle();
+
+            bool usesDedicatedTransferQueue() const;
+
+            const UploadStatistics& getStatistics() const;
+
+        private:
+            static constexpr VkDeviceSize staging_alignment {16};
+
+            static constexpr std::uint64_t wait_timeout {9'999'999'999};
+
+            // Staging copies at least this large are split across the job workers
+            static constexpr VkDeviceSize parallel_copy_block_size {1 << 20};
+
+            enum class BatchState : std::uint8_t
+            {
+                Recording,
+                Transferring,
+                Acquiring
+            };
+
+            struct DedicatedStaging
+            {
+                VkBuffer buffer;
+                VmaAllocation allocation;
+            };
+
+            struct UploadBatch
+            {
+                std::uint64_t ticket;
+                std::uint64_t acquire_value;
+
+                BatchState state;
+
+                VkCommandBuffer transfer_command_buffer;
+
+                VkDeviceSize ring_footprint;
+                VkDeviceSize uploaded_bytes;
+
+                std::vector<DedicatedStaging> dedicated_staging;
+
+                std::vector<VkBufferMemoryBarrier2> buffer_releases;
+                std::vector<VkImageMemoryBarrier2> image_releases;
+
+                std::vector<VkBufferMemoryBarrier2> buffer_acquires;
+                std::vector<VkImageMemoryBarrier2> image_acquires;
+
+                std::chrono::steady_clock::time_point submit_time;
+            };
+
+            struct AcquireSubmission
+            {
+                std::uint64_t value;
+
+                VkCommandBuffer command_buffer;
+            };
+
+            struct StagingSpace
+            {
+                VkBuffer buffer;
+                VkDeviceSize offset;
+
+                std::byte* data;
+            };
+
+            VkDevice device {};
+            VmaAllocator allocator {};
+
+            JobSystem* job_system {};
+
+            VkQueue graphics_queue {};
+            std::uint32_t graphics_queue_family {};
+
+            VkQueue transfer_queue {};
+            std::uint32_t transfer_queue_family {};
+
+            VkCommandPool transfer_command_pool {};
+            VkCommandPool acquire_command_pool {};
+
+            VkBuffer staging_buffer {};
+            VmaAllocation staging_allocation {};
+
+            StagingRing staging_ring;
+
+            // Signalled by transfer submissions, values double as upload tickets
+            TimelineSemaphore transfer_timeline;
+
+            // Signalled by the graphics-queue ownership acquires
+            TimelineSemaphore acquire_timeline;
+
+            // Oldest first, the back batch is the open one while recording
+            std::deque<UploadBatch> batches;
+            std::deque<AcquireSubmission> acquire_submissions;
+
+            std::uint64_t ready_ticket {};
+
+            UploadStatistics statistics {};
+
+            UploadBatch& getRecordingBatch();
+
+            StagingSpace allocateStaging(const VkDeviceSize size);
+
+            void copyToStaging(std::byte* const destination, const void* const source, const VkDeviceSize size);
+
+            void addBufferRelease(UploadBatch& batch, VkBufferMemoryBarrier2 release);
+            void addImageRelease(UploadBatch& batch, VkImageMemoryBarrier2 release);
+
+            void retireTransfers();
+            void submitAcquires(const std::span<UploadBatch* const> transferred_batches);
+    };
+}
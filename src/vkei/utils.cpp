@@ -78,7 +78,7 @@ namespace mdsm::vkei
         return info;
     }
     
-    VkCommandBufferAllocateInfo generateCommandBufferAllocateInfo(const VkCommandPool pool, const std::uint32_t count)
+    VkCommandBufferAllocateInfo generateCommandBufferAllocateInfo(const VkCommandPool pool, const std::uint32_t count, const VkCommandBufferLevel level)
     {
         VkCommandBufferAllocateInfo info {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -87,7 +87,7 @@ namespace mdsm::vkei
     
         info.commandPool = pool;
         info.commandBufferCount = count;
-        info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        info.level = level;
     
         return info;
     }
@@ -143,7 +143,7 @@ namespace mdsm::vkei
         return sub_image;
     }
     
-    VkSemaphoreSubmitInfo generateSemaphoreSubmitInfo(const VkPipelineStageFlags2 stage_mask, const VkSemaphore semaphore)
+    VkSemaphoreSubmitInfo generateSemaphoreSubmitInfo(const VkPipelineStageFlags2 stage_mask, const VkSemaphore semaphore, const std::uint64_t value)
     {
         VkSemaphoreSubmitInfo info {
             .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
@@ -153,7 +153,7 @@ namespace mdsm::vkei
         info.semaphore = semaphore;
         info.stageMask = stage_mask;
         info.deviceIndex = 0;
-        info.value = 1;
+        info.value = value;
     
         return info;
     }
@@ -189,39 +189,24 @@ namespace mdsm::vkei
     
         return info;
     }
-    
-    void changeImageLayout(const VkCommandBuffer command_buffer, const VkImage image, const VkImageLayout current_layout, const VkImageLayout new_layout)
+
+    VkSubmitInfo2 generateSubmitInfo(const VkCommandBufferSubmitInfo *command_buffer, const std::span<const VkSemaphoreSubmitInfo> signal_semaphore_infos, const std::span<const VkSemaphoreSubmitInfo> wait_semaphore_infos)
     {
-        VkImageMemoryBarrier2 image_barrier {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        VkSubmitInfo2 info {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
             .pNext = nullptr
         };
     
-        image_barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-        image_barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-        image_barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-        image_barrier.dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT;
+        info.waitSemaphoreInfoCount = static_cast<std::uint32_t>(wait_semaphore_infos.size());
+        info.pWaitSemaphoreInfos = wait_semaphore_infos.data();
     
-        image_barrier.oldLayout = current_layout;
-        image_barrier.newLayout = new_layout;
+        info.signalSemaphoreInfoCount = static_cast<std::uint32_t>(signal_semaphore_infos.size());
+        info.pSignalSemaphoreInfos = signal_semaphore_infos.data();
     
-        VkImageAspectFlags aspect_mask {
-            new_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL? 
-            VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT
-        };     
-    
-        image_barrier.subresourceRange = generateImageSubresourceRange(aspect_mask);
-        image_barrier.image = image;
-    
-        VkDependencyInfo dependency_info {
-            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-            .pNext = nullptr
-        };
-    
-        dependency_info.imageMemoryBarrierCount = 1;
-        dependency_info.pImageMemoryBarriers = &image_barrier;
+        info.commandBufferInfoCount = 1;
+        info.pCommandBufferInfos = command_buffer;
     
-        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        return info;
     }
     
     void copyImage(const VkCommandBuffer command_buffer, const VkImage source, const VkImage destination, const VkExtent2D source_size, const VkExtent2D destination_size)
@@ -265,6 +250,38 @@ namespace mdsm::vkei
         vkCmdBlitImage2(command_buffer, &blit_info);    
     }
     
+    void copyImageToBuffer(const VkCommandBuffer command_buffer, const VkImage source, const VkBuffer destination, const VkExtent2D source_size)
+    {
+        VkBufferImageCopy2 copy_region {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+            .pNext = nullptr
+        };
+
+        copy_region.bufferOffset = 0;
+        copy_region.bufferRowLength = 0;
+        copy_region.bufferImageHeight = 0;
+
+        copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy_region.imageSubresource.mipLevel = 0;
+        copy_region.imageSubresource.baseArrayLayer = 0;
+        copy_region.imageSubresource.layerCount = 1;
+
+        copy_region.imageExtent = VkExtent3D{source_size.width, source_size.height, 1};
+
+        VkCopyImageToBufferInfo2 copy_info {
+            .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_BUFFER_INFO_2,
+            .pNext = nullptr
+        };
+
+        copy_info.srcImage = source;
+        copy_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        copy_info.dstBuffer = destination;
+        copy_info.regionCount = 1;
+        copy_info.pRegions = &copy_region;
+
+        vkCmdCopyImageToBuffer2(command_buffer, &copy_info);
+    }
+    
     VkRenderingAttachmentInfo generateDepthAttachmentInfo(const VkImageView view, const VkImageLayout layout)
     {
         VkRenderingAttachmentInfo depth_attachment {
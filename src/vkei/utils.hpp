@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string_view>
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
@@ -20,7 +21,9 @@ namespace mdsm::vkei
     );
     
     VkCommandBufferAllocateInfo generateCommandBufferAllocateInfo(
-        const VkCommandPool pool, const std::uint32_t count = 1
+        const VkCommandPool pool,
+        const std::uint32_t count = 1,
+        const VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY
     );
     
     VkFenceCreateInfo generateFenceCreateinfo(const VkFenceCreateFlags flags = {});
@@ -37,7 +40,8 @@ namespace mdsm::vkei
     
     VkSemaphoreSubmitInfo generateSemaphoreSubmitInfo(
         const VkPipelineStageFlags2 stage_mask,
-        const VkSemaphore semaphore
+        const VkSemaphore semaphore,
+        const std::uint64_t value = 1
     );
     
     VkCommandBufferSubmitInfo generateCommandBufferSubmitInfo(
@@ -49,12 +53,11 @@ namespace mdsm::vkei
         const VkSemaphoreSubmitInfo* signal_semaphore_info,
         const VkSemaphoreSubmitInfo* wait_semaphore_info
     );
-    
-    void changeImageLayout(
-        const VkCommandBuffer command_buffer,
-        const VkImage image,
-        const VkImageLayout current_layout,
-        const VkImageLayout new_layout
+
+    VkSubmitInfo2 generateSubmitInfo(
+        const VkCommandBufferSubmitInfo* command_buffer,
+        const std::span<const VkSemaphoreSubmitInfo> signal_semaphore_infos,
+        const std::span<const VkSemaphoreSubmitInfo> wait_semaphore_infos
     );
     
     void copyImage(
@@ -65,6 +68,13 @@ namespace mdsm::vkei
         const VkExtent2D destination_size
     );
     
+    void copyImageToBuffer(
+        const VkCommandBuffer command_buffer,
+        const VkImage source,
+        const VkBuffer destination,
+        const VkExtent2D source_size
+    );
+    
     VkPipelineShaderStageCreateInfo generatePipelineShaderStageCreateInfo(
         const VkShaderStageFlagBits stage,
         const VkShaderModule shader_module,
@@ -1,11 +1,32 @@
 #pragma once
 
+#include "barrier_batch.hpp"
+#include "bindless_table.hpp"
 #include "descriptor_allocator.hpp"
+#include "descriptor_buffer.hpp"
 #include "descriptor_layout_builder.hpp"
+#include "descriptor_pool_recycler.hpp"
+#include "descriptor_set_cache.hpp"
 #include "descriptor_writer.hpp"
 #include"engine.hpp"
+#include "free_list_allocator.hpp"
+#include "frustum_culler.hpp"
+#include "geometry_pool.hpp"
+#include "gpu_culler.hpp"
+#include "gpu_profiler.hpp"
+#include "gpu_scene.hpp"
+#include "image_state_tracker.hpp"
+#include "job_system.hpp"
 #include"pipeline_builder.hpp"
+#include "radix_sort.hpp"
+#include "render_graph.hpp"
 #include "resource_cleaner.hpp"
+#include "resource_usage.hpp"
+#include "rolling_statistics.hpp"
 #include "shader.hpp"
+#include "staging_ring.hpp"
+#include "timeline_semaphore.hpp"
+#include "transient_arena.hpp"
 #include "types.hpp"
+#include "upload_service.hpp"
 #include "utils.hpp"
\ No newline at end of file